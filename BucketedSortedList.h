@@ -0,0 +1,613 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "NodePool.h"
+#include "SortedList.h"
+
+namespace mtm {
+
+    /**
+     * @brief Storage policy for SortedList that keeps the elements in one bucket per key.
+     *
+     * SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>> is for elements whose order is decided first
+     * by a small integer key in [0, MaxKey], larger keys first - like the priority of a task. Compare must agree
+     * with that order and decides the order inside a bucket. A bitmap of the occupied buckets finds where an
+     * element of a new key goes, so the first element is always at hand and inserting only walks its own bucket,
+     * from both ends at once - O(1) when an element goes at either end of its bucket, like a new task with the
+     * highest ID, or an old task bumped into a bucket of newer ones.
+     *
+     * @tparam KeyFunction Returns the key of an element, an int in [0, MaxKey].
+     * @tparam MaxKey The largest key.
+     */
+    template <typename KeyFunction, int MaxKey>
+    struct PriorityBuckets {};
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    class SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>> {
+        static_assert(MaxKey >= 0, "keys start at 0");
+
+        static const int NUM_BUCKETS = MaxKey + 1;
+        static const int WORD_BITS = 64;
+        static const int NUM_WORDS = (NUM_BUCKETS + WORD_BITS - 1) / WORD_BITS;
+
+        struct Node;
+
+        Compare m_compare;
+        KeyFunction m_key;
+        NodePool<Node> m_pool;
+        Node* m_head;
+        Node* m_tail;
+        unsigned int m_size;
+
+        // first and last node of every bucket, and a bit for every bucket that isn't empty
+        Node* m_bucketFirst[NUM_BUCKETS];
+        Node* m_bucketLast[NUM_BUCKETS];
+        std::uint64_t m_occupied[NUM_WORDS];
+
+        int bucketOf(const T& data) const;
+        int occupiedAbove(int bucket) const noexcept;
+
+        template <typename... Args>
+        Node* createNode(Args&&... args);
+        void destroyNode(Node* node) noexcept;
+        void clear() noexcept;
+        void link(Node* node) noexcept;
+        void unlink(Node* node) noexcept;
+
+    public:
+
+        // constructors
+
+        SortedList();
+
+        explicit SortedList(const Compare& compare);
+
+        SortedList(const SortedList& other);
+
+        SortedList(SortedList&& other) noexcept;
+
+        template <typename InputIterator>
+        SortedList(InputIterator first, InputIterator last, const Compare& compare = Compare());
+
+        ~SortedList();
+
+        SortedList& operator=(const SortedList& other);
+
+        SortedList& operator=(SortedList&& other) noexcept;
+
+        // iterator
+
+        class ConstIterator;
+
+        ConstIterator begin() const;
+
+        ConstIterator end() const;
+
+        // methods
+
+        SortedList &insert(const T &newData);
+
+        SortedList &insert(T &&newData);
+
+        template <typename... Args>
+        ConstIterator emplace(Args&&... args);
+
+        template <typename InputIterator>
+        SortedList &insertRange(InputIterator first, InputIterator last);
+
+        SortedList &remove(const ConstIterator &givenIt);
+
+        ConstIterator replace(const ConstIterator &givenIt, T newData);
+
+        int length() const;
+
+        const Compare& getCompare() const;
+
+        ConstIterator find(const T& data) const;
+
+        // the buckets already find every position quickly, the index methods are kept so the lists can be swapped
+
+        SortedList &enableIndex();
+
+        SortedList &disableIndex();
+
+        bool isIndexed() const;
+
+        template <typename Function>
+        SortedList filter(Function filterFunction) const;
+
+        template <typename Function>
+        SortedList apply(Function applyFunction) const;
+
+        template <typename Predicate, typename Function>
+        SortedList &applyInPlace(Predicate predicate, Function applyFunction);
+
+        template <typename Predicate>
+        FilteredView<SortedList, Predicate> filtered(Predicate predicate) const;
+
+        template <typename Function>
+        TransformedView<SortedList, Function> transformed(Function function) const;
+    };
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    struct SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::Node {
+        T m_data;
+        Node* m_next;
+        Node* m_prev;
+        int m_bucket;
+
+        template <typename... Args>
+        explicit Node(int bucket, Args&&... args)
+            : m_data(std::forward<Args>(args)...), m_next(nullptr), m_prev(nullptr), m_bucket(bucket) {}
+    };
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    class SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator {
+        friend SortedList;
+
+        const Node* m_currentNode;
+
+        // private constructors
+        explicit ConstIterator(const Node* node);
+
+    public:
+
+        ConstIterator(const ConstIterator& other) = default;
+        ConstIterator& operator=(const ConstIterator& other) = default;
+        ~ConstIterator() = default;
+
+        const T& operator*() const;
+        ConstIterator& operator++();
+        bool operator!=(const ConstIterator& other) const;
+    };
+
+    // ------------------------------- SortedList ------------------------------- //
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::SortedList() : SortedList(Compare()) {}
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::SortedList(const Compare& compare)
+        : m_compare(compare), m_key(), m_pool(), m_head(nullptr), m_tail(nullptr), m_size(0),
+          m_bucketFirst(), m_bucketLast(), m_occupied() {}
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::SortedList(const SortedList& other)
+        : SortedList(other.m_compare) {
+        try {
+            // the other list is already in order, so every node goes at the back of its bucket
+            for (const Node* cur = other.m_head; cur != nullptr; cur = cur->m_next) {
+                link(createNode(cur->m_data));
+            }
+        }
+        catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::SortedList(SortedList&& other) noexcept
+        : m_compare(other.m_compare), m_key(other.m_key), m_pool(std::move(other.m_pool)), m_head(other.m_head),
+          m_tail(other.m_tail), m_size(other.m_size) {
+        std::copy(other.m_bucketFirst, other.m_bucketFirst + NUM_BUCKETS, m_bucketFirst);
+        std::copy(other.m_bucketLast, other.m_bucketLast + NUM_BUCKETS, m_bucketLast);
+        std::copy(other.m_occupied, other.m_occupied + NUM_WORDS, m_occupied);
+        other.m_head = other.m_tail = nullptr;
+        other.m_size = 0;
+        std::fill(other.m_bucketFirst, other.m_bucketFirst + NUM_BUCKETS, nullptr);
+        std::fill(other.m_bucketLast, other.m_bucketLast + NUM_BUCKETS, nullptr);
+        std::fill(other.m_occupied, other.m_occupied + NUM_WORDS, 0);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename InputIterator>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::SortedList(InputIterator first, InputIterator last,
+                                                                          const Compare& compare)
+        : SortedList(compare) {
+        insertRange(first, last);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::~SortedList() {
+        clear();
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::operator=(const SortedList& other) {
+        if (this == &other) {
+            return *this;
+        }
+        SortedList copy(other); // if copying fails, this list is left as it was
+        *this = std::move(copy);
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::operator=(SortedList&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        m_compare = other.m_compare;
+        m_key = other.m_key;
+        m_pool = std::move(other.m_pool); // the nodes live in the pool, so it moves together with them
+        m_head = other.m_head;
+        m_tail = other.m_tail;
+        m_size = other.m_size;
+        std::copy(other.m_bucketFirst, other.m_bucketFirst + NUM_BUCKETS, m_bucketFirst);
+        std::copy(other.m_bucketLast, other.m_bucketLast + NUM_BUCKETS, m_bucketLast);
+        std::copy(other.m_occupied, other.m_occupied + NUM_WORDS, m_occupied);
+        other.m_head = other.m_tail = nullptr;
+        other.m_size = 0;
+        std::fill(other.m_bucketFirst, other.m_bucketFirst + NUM_BUCKETS, nullptr);
+        std::fill(other.m_bucketLast, other.m_bucketLast + NUM_BUCKETS, nullptr);
+        std::fill(other.m_occupied, other.m_occupied + NUM_WORDS, 0);
+        return *this;
+    }
+
+    // methods
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    typename SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::begin() const {
+        return ConstIterator(m_head);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    typename SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::end() const {
+        return ConstIterator(nullptr);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::insert(const T &newData) {
+        link(createNode(newData));
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::insert(T &&newData) {
+        link(createNode(std::move(newData)));
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename... Args>
+    typename SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::emplace(Args&&... args) {
+        Node* newNode = createNode(std::forward<Args>(args)...);
+        link(newNode);
+        return ConstIterator(newNode);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename InputIterator>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::insertRange(InputIterator first, InputIterator last) {
+        // create all the nodes first, so if one of them fails the list is left as it was
+        std::vector<Node*> newNodes;
+        try {
+            for (; first != last; ++first) {
+                newNodes.push_back(nullptr);
+                newNodes.back() = createNode(*first);
+            }
+        }
+        catch (...) {
+            for (Node* node : newNodes) {
+                if (node != nullptr) {
+                    destroyNode(node);
+                }
+            }
+            throw;
+        }
+        for (Node* node : newNodes) {
+            link(node);
+        }
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::remove(const ConstIterator &givenIt) {
+        Node* victim = const_cast<Node*>(givenIt.m_currentNode);
+        if (victim == nullptr) {
+            return *this;
+        }
+        unlink(victim);
+        destroyNode(victim);
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    typename SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::replace(const ConstIterator &givenIt, T newData) {
+        Node* node = const_cast<Node*>(givenIt.m_currentNode);
+        if (node == nullptr) {
+            return end();
+        }
+        const int newBucket = bucketOf(newData);
+        node->m_data = std::move(newData);
+        unlink(node);
+        node->m_bucket = newBucket;
+        link(node);
+        return ConstIterator(node);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    int SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::length() const {
+        return m_size;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    const Compare& SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::getCompare() const {
+        return m_compare;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    typename SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::find(const T &data) const {
+        const int key = m_key(data);
+        if (key < 0 || key > MaxKey) {
+            return end();
+        }
+        // only the bucket of data can hold an equal element
+        const Node* cur = m_bucketFirst[key];
+        while (cur != nullptr && cur->m_bucket == key && m_compare(cur->m_data, data)) {
+            cur = cur->m_next;
+        }
+        if (cur != nullptr && cur->m_bucket == key && !m_compare(data, cur->m_data)) {
+            return ConstIterator(cur);
+        }
+        return end();
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::enableIndex() {
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::disableIndex() {
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    bool SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::isIndexed() const {
+        return false;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename Function>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::filter(Function filterFunction) const {
+        const FilteredView<SortedList, Function> view = filtered(filterFunction);
+        return SortedList(view.begin(), view.end(), m_compare); // in order, so every node goes at the back
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename Function>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::apply(Function applyFunction) const {
+        const TransformedView<SortedList, Function> view = transformed(applyFunction);
+        return SortedList(view.begin(), view.end(), m_compare);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename Predicate, typename Function>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::applyInPlace(Predicate predicate, Function applyFunction) {
+        // compute every new value before changing anything, so if one of them fails the list is left as it was
+        std::vector<Node*> changed;
+        std::vector<T> newValues;
+        std::vector<int> newBuckets;
+        for (Node* cur = m_head; cur != nullptr; cur = cur->m_next) {
+            if (predicate(cur->m_data)) {
+                changed.push_back(cur);
+                newValues.push_back(applyFunction(static_cast<const T&>(cur->m_data)));
+                newBuckets.push_back(bucketOf(newValues.back()));
+            }
+        }
+        for (Node* node : changed) {
+            unlink(node);
+        }
+        for (std::size_t i = 0; i < changed.size(); ++i) {
+            changed[i]->m_data = std::move(newValues[i]);
+            changed[i]->m_bucket = newBuckets[i];
+            link(changed[i]);
+        }
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename Predicate>
+    FilteredView<SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>, Predicate>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::filtered(Predicate predicate) const {
+        return FilteredView<SortedList, Predicate>(*this, predicate);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename Function>
+    TransformedView<SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>, Function>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::transformed(Function function) const {
+        return TransformedView<SortedList, Function>(*this, function);
+    }
+
+    // -------------------------------- Iterator -------------------------------- //
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator::ConstIterator(const Node* node)
+        : m_currentNode(node) {}
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    const T& SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator::operator*() const {
+        if (m_currentNode == nullptr) {
+            throw std::out_of_range("No data");
+        }
+        return m_currentNode->m_data;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    typename SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator&
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator::operator++() {
+        if (m_currentNode == nullptr) {
+            throw std::out_of_range("Out of range");
+        }
+        m_currentNode = m_currentNode->m_next;
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    bool SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::ConstIterator::operator!=(const ConstIterator& other) const {
+        return m_currentNode != other.m_currentNode;
+    }
+
+    // ---------------------------------- Helper ---------------------------------- //
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    int SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::bucketOf(const T& data) const {
+        const int key = m_key(data);
+        if (key < 0 || key > MaxKey) {
+            throw std::out_of_range("Key out of range");
+        }
+        return key;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    int SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::occupiedAbove(int bucket) const noexcept {
+        // the lowest occupied bucket with a larger key than bucket, or -1 if there is none
+        int first = bucket + 1;
+        for (int word = first / WORD_BITS; word < NUM_WORDS; ++word) {
+            std::uint64_t bits = m_occupied[word];
+            if (word == first / WORD_BITS) {
+                bits &= ~std::uint64_t(0) << (first % WORD_BITS);
+            }
+            if (bits != 0) {
+                return word * WORD_BITS + __builtin_ctzll(bits);
+            }
+        }
+        return -1;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    template <typename... Args>
+    typename SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::Node*
+    SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::createNode(Args&&... args) {
+        Node* node = m_pool.allocate(1);
+        try {
+            new (node) Node(0, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            m_pool.deallocate(node, 1);
+            throw;
+        }
+        try {
+            node->m_bucket = bucketOf(node->m_data);
+        }
+        catch (...) {
+            destroyNode(node);
+            throw;
+        }
+        return node;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    void SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::destroyNode(Node* node) noexcept {
+        node->~Node();
+        m_pool.deallocate(node, 1);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    void SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::clear() noexcept {
+        while (m_head != nullptr) {
+            Node* toDelete = m_head;
+            m_head = m_head->m_next;
+            destroyNode(toDelete);
+        }
+        m_tail = nullptr;
+        m_size = 0;
+        std::fill(m_bucketFirst, m_bucketFirst + NUM_BUCKETS, nullptr);
+        std::fill(m_bucketLast, m_bucketLast + NUM_BUCKETS, nullptr);
+        std::fill(m_occupied, m_occupied + NUM_WORDS, 0);
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    void SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::link(Node* node) noexcept {
+        const int bucket = node->m_bucket;
+        Node* prev;
+        if (m_bucketLast[bucket] != nullptr) {
+            Node* const first = m_bucketFirst[bucket];
+            Node* const last = m_bucketLast[bucket];
+            if (!m_compare(node->m_data, last->m_data)) {
+                prev = last; // equal elements keep their order
+            }
+            else {
+                // walk the bucket from both ends at once, so the node is found as fast as from the closer one
+                Node* front = first;
+                Node* back = last;
+                while (true) {
+                    if (m_compare(node->m_data, front->m_data)) {
+                        prev = front->m_prev;
+                        break;
+                    }
+                    front = front->m_next;
+                    back = back->m_prev;
+                    if (!m_compare(node->m_data, back->m_data)) {
+                        prev = back;
+                        break;
+                    }
+                }
+            }
+            if (prev == first->m_prev) {
+                m_bucketFirst[bucket] = node;
+            }
+            if (prev == last) {
+                m_bucketLast[bucket] = node;
+            }
+        }
+        else {
+            // a new bucket goes right after the closest bucket with a larger key
+            const int above = occupiedAbove(bucket);
+            prev = above < 0 ? nullptr : m_bucketLast[above];
+            m_bucketFirst[bucket] = m_bucketLast[bucket] = node;
+            m_occupied[bucket / WORD_BITS] |= std::uint64_t(1) << (bucket % WORD_BITS);
+        }
+
+        Node* next = prev != nullptr ? prev->m_next : m_head;
+        node->m_prev = prev;
+        node->m_next = next;
+        (prev != nullptr ? prev->m_next : m_head) = node;
+        (next != nullptr ? next->m_prev : m_tail) = node;
+        m_size++;
+    }
+
+    template <typename T, typename Compare, typename KeyFunction, int MaxKey>
+    void SortedList<T, Compare, PriorityBuckets<KeyFunction, MaxKey>>::unlink(Node* node) noexcept {
+        const int bucket = node->m_bucket;
+        if (m_bucketFirst[bucket] == node && m_bucketLast[bucket] == node) {
+            m_bucketFirst[bucket] = m_bucketLast[bucket] = nullptr;
+            m_occupied[bucket / WORD_BITS] &= ~(std::uint64_t(1) << (bucket % WORD_BITS));
+        }
+        else if (m_bucketFirst[bucket] == node) {
+            m_bucketFirst[bucket] = node->m_next;
+        }
+        else if (m_bucketLast[bucket] == node) {
+            m_bucketLast[bucket] = node->m_prev;
+        }
+        (node->m_prev != nullptr ? node->m_prev->m_next : m_head) = node->m_next;
+        (node->m_next != nullptr ? node->m_next->m_prev : m_tail) = node->m_prev;
+        node->m_next = node->m_prev = nullptr;
+        m_size--;
+    }
+}
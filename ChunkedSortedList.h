@@ -0,0 +1,465 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SortedList.h"
+
+namespace mtm {
+
+    /**
+     * @brief Storage policy for SortedList that keeps the elements in chunks of a few cache lines each.
+     *
+     * SortedList<T, Compare, ChunkedStorage<>> is an unrolled linked list: every chunk holds a sorted array of elements,
+     * so walking the list reads memory in order and only jumps between chunks. Inserting and removing shift
+     * elements inside one chunk, which also means they invalidate the iterators into that chunk.
+     *
+     * @tparam CacheLines The size of a chunk in 64-byte cache lines. A chunk holds at least 4 elements.
+     */
+    template <std::size_t CacheLines = 4>
+    struct ChunkedStorage {};
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    class SortedList<T, Compare, ChunkedStorage<CacheLines>> {
+        static_assert(std::is_nothrow_move_constructible<T>::value,
+                      "chunked storage moves elements around and needs a move constructor that doesn't throw");
+
+        static const std::size_t CACHE_LINE_SIZE = 64;
+        static const std::size_t CHUNK_CAPACITY =
+            CacheLines * CACHE_LINE_SIZE / sizeof(T) > 4 ? CacheLines * CACHE_LINE_SIZE / sizeof(T) : 4;
+
+        struct Chunk;
+
+        Compare m_compare;
+        Chunk* m_head;
+        Chunk* m_tail;
+        unsigned int m_size;
+
+        Chunk* createChunkAfter(Chunk* prev);
+        void destroyChunk(Chunk* chunk) noexcept;
+        void clear() noexcept;
+        void pushBack(T&& data);
+        void insertValue(T&& data);
+
+    public:
+
+        // constructors
+
+        SortedList();
+
+        explicit SortedList(const Compare& compare);
+
+        SortedList(const SortedList& other);
+
+        SortedList(SortedList&& other) noexcept;
+
+        template <typename InputIterator>
+        SortedList(InputIterator first, InputIterator last, const Compare& compare = Compare());
+
+        ~SortedList();
+
+        SortedList& operator=(const SortedList& other);
+
+        SortedList& operator=(SortedList&& other) noexcept;
+
+        // iterator
+
+        class ConstIterator;
+
+        ConstIterator begin() const;
+
+        ConstIterator end() const;
+
+        // methods
+
+        SortedList &insert(const T &newData);
+
+        SortedList &insert(T &&newData);
+
+        SortedList &remove(const ConstIterator &givenIt);
+
+        int length() const;
+
+        const Compare& getCompare() const;
+
+        template <typename Function>
+        SortedList filter(Function filterFunction) const;
+
+        template <typename Function>
+        SortedList apply(Function applyFunction) const;
+
+        template <typename Predicate>
+        FilteredView<SortedList, Predicate> filtered(Predicate predicate) const;
+
+        template <typename Function>
+        TransformedView<SortedList, Function> transformed(Function function) const;
+    };
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    struct SortedList<T, Compare, ChunkedStorage<CacheLines>>::Chunk {
+        Chunk* m_next;
+        Chunk* m_prev;
+        std::size_t m_count;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_slots[CHUNK_CAPACITY];
+
+        T* at(std::size_t index) {
+            return std::launder(reinterpret_cast<T*>(&m_slots[index]));
+        }
+
+        const T* at(std::size_t index) const {
+            return std::launder(reinterpret_cast<const T*>(&m_slots[index]));
+        }
+
+        // moves the elements [from, m_count) one slot to the right, the slot at from is left empty
+        void openGap(std::size_t from) noexcept {
+            for (std::size_t i = m_count; i > from; --i) {
+                new (&m_slots[i]) T(std::move(*at(i - 1)));
+                at(i - 1)->~T();
+            }
+        }
+
+        // moves the elements (at, m_count) one slot to the left, over the empty slot at
+        void closeGap(std::size_t gap) noexcept {
+            for (std::size_t i = gap; i + 1 < m_count; ++i) {
+                new (&m_slots[i]) T(std::move(*at(i + 1)));
+                at(i + 1)->~T();
+            }
+        }
+    };
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    class SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator {
+        friend SortedList;
+
+        const Chunk* m_chunk;
+        std::size_t m_index;
+
+        // private constructors
+        ConstIterator(const Chunk* chunk, std::size_t index);
+
+    public:
+
+        ConstIterator(const ConstIterator& other) = default;
+        ConstIterator& operator=(const ConstIterator& other) = default;
+        ~ConstIterator() = default;
+
+        const T& operator*() const;
+        ConstIterator& operator++();
+        bool operator!=(const ConstIterator& other) const;
+    };
+
+    // ------------------------------- SortedList ------------------------------- //
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::SortedList() : SortedList(Compare()) {}
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::SortedList(const Compare& compare)
+        : m_compare(compare), m_head(nullptr), m_tail(nullptr), m_size(0) {}
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::SortedList(const SortedList& other) : SortedList(other.m_compare) {
+        try {
+            for (const Chunk* chunk = other.m_head; chunk != nullptr; chunk = chunk->m_next) {
+                Chunk* newChunk = createChunkAfter(m_tail);
+                for (std::size_t i = 0; i < chunk->m_count; ++i) {
+                    new (&newChunk->m_slots[i]) T(*chunk->at(i));
+                    newChunk->m_count++;
+                }
+            }
+            m_size = other.m_size;
+        }
+        catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::SortedList(SortedList&& other) noexcept
+        : m_compare(other.m_compare), m_head(other.m_head), m_tail(other.m_tail), m_size(other.m_size) {
+        other.m_head = other.m_tail = nullptr;
+        other.m_size = 0;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    template <typename InputIterator>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::SortedList(InputIterator first, InputIterator last,
+                                                                  const Compare& compare)
+        : SortedList(compare) {
+        // sort the range once and fill the chunks from the front
+        std::vector<T> values;
+        for (; first != last; ++first) {
+            values.push_back(*first);
+        }
+        const auto comesFirst = [this](const T& lhs, const T& rhs) {
+            return m_compare(lhs, rhs);
+        };
+        if (!std::is_sorted(values.begin(), values.end(), comesFirst)) {
+            std::stable_sort(values.begin(), values.end(), comesFirst);
+        }
+        try {
+            for (T& value : values) {
+                pushBack(std::move(value));
+            }
+        }
+        catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::~SortedList() {
+        clear();
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>& SortedList<T, Compare, ChunkedStorage<CacheLines>>::operator=(const SortedList& other) {
+        if (this == &other) {
+            return *this;
+        }
+        SortedList copy(other); // if copying fails, this list is left as it was
+        *this = std::move(copy);
+        return *this;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>& SortedList<T, Compare, ChunkedStorage<CacheLines>>::operator=(SortedList&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        m_compare = other.m_compare;
+        m_head = other.m_head;
+        m_tail = other.m_tail;
+        m_size = other.m_size;
+        other.m_head = other.m_tail = nullptr;
+        other.m_size = 0;
+        return *this;
+    }
+
+    // methods
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    typename SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator SortedList<T, Compare, ChunkedStorage<CacheLines>>::begin() const {
+        return ConstIterator(m_head, 0);
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    typename SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator SortedList<T, Compare, ChunkedStorage<CacheLines>>::end() const {
+        return ConstIterator(nullptr, 0);
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>> &SortedList<T, Compare, ChunkedStorage<CacheLines>>::insert(const T &newData) {
+        insertValue(T(newData)); // copy first, everything after that only moves
+        return *this;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>> &SortedList<T, Compare, ChunkedStorage<CacheLines>>::insert(T &&newData) {
+        insertValue(std::move(newData));
+        return *this;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>> &SortedList<T, Compare, ChunkedStorage<CacheLines>>::remove(const ConstIterator &givenIt) {
+        Chunk* chunk = const_cast<Chunk*>(givenIt.m_chunk);
+        if (chunk == nullptr) {
+            return *this;
+        }
+        chunk->at(givenIt.m_index)->~T();
+        chunk->closeGap(givenIt.m_index);
+        chunk->m_count--;
+        m_size--;
+
+        if (chunk->m_count == 0) {
+            destroyChunk(chunk);
+        }
+        else if (chunk->m_next != nullptr && chunk->m_count + chunk->m_next->m_count <= CHUNK_CAPACITY / 2) {
+            // keep the chunks reasonably full by joining two small neighbours
+            Chunk* next = chunk->m_next;
+            for (std::size_t i = 0; i < next->m_count; ++i) {
+                new (&chunk->m_slots[chunk->m_count + i]) T(std::move(*next->at(i)));
+            }
+            chunk->m_count += next->m_count;
+            destroyChunk(next);
+        }
+        return *this;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    int SortedList<T, Compare, ChunkedStorage<CacheLines>>::length() const {
+        return m_size;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    const Compare& SortedList<T, Compare, ChunkedStorage<CacheLines>>::getCompare() const {
+        return m_compare;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    template <typename Function>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>> SortedList<T, Compare, ChunkedStorage<CacheLines>>::filter(Function filterFunction) const {
+        SortedList newList(m_compare);
+        for (const T& data : *this) {
+            if (filterFunction(data)) {
+                newList.pushBack(T(data)); // the elements come in order, so they always go at the end
+            }
+        }
+        return newList;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    template <typename Function>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>> SortedList<T, Compare, ChunkedStorage<CacheLines>>::apply(Function applyFunction) const {
+        const TransformedView<SortedList, Function> view = transformed(applyFunction);
+        return SortedList(view.begin(), view.end(), m_compare);
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    template <typename Predicate>
+    FilteredView<SortedList<T, Compare, ChunkedStorage<CacheLines>>, Predicate>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::filtered(Predicate predicate) const {
+        return FilteredView<SortedList, Predicate>(*this, predicate);
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    template <typename Function>
+    TransformedView<SortedList<T, Compare, ChunkedStorage<CacheLines>>, Function>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::transformed(Function function) const {
+        return TransformedView<SortedList, Function>(*this, function);
+    }
+
+    // -------------------------------- Iterator -------------------------------- //
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator::ConstIterator(const Chunk* chunk, std::size_t index)
+        : m_chunk(chunk), m_index(index) {}
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    const T& SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator::operator*() const {
+        if (m_chunk == nullptr) {
+            throw std::out_of_range("No data");
+        }
+        return *m_chunk->at(m_index);
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    typename SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator&
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator::operator++() {
+        if (m_chunk == nullptr) {
+            throw std::out_of_range("Out of range");
+        }
+        if (++m_index == m_chunk->m_count) {
+            m_chunk = m_chunk->m_next;
+            m_index = 0;
+        }
+        return *this;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    bool SortedList<T, Compare, ChunkedStorage<CacheLines>>::ConstIterator::operator!=(const ConstIterator& other) const {
+        return m_chunk != other.m_chunk || m_index != other.m_index;
+    }
+
+    // ---------------------------------- Helper ---------------------------------- //
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    typename SortedList<T, Compare, ChunkedStorage<CacheLines>>::Chunk*
+    SortedList<T, Compare, ChunkedStorage<CacheLines>>::createChunkAfter(Chunk* prev) {
+        Chunk* chunk = new Chunk;
+        chunk->m_count = 0;
+        chunk->m_prev = prev;
+        chunk->m_next = prev != nullptr ? prev->m_next : m_head;
+        (chunk->m_next != nullptr ? chunk->m_next->m_prev : m_tail) = chunk;
+        (prev != nullptr ? prev->m_next : m_head) = chunk;
+        return chunk;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    void SortedList<T, Compare, ChunkedStorage<CacheLines>>::destroyChunk(Chunk* chunk) noexcept {
+        for (std::size_t i = 0; i < chunk->m_count; ++i) {
+            chunk->at(i)->~T();
+        }
+        (chunk->m_prev != nullptr ? chunk->m_prev->m_next : m_head) = chunk->m_next;
+        (chunk->m_next != nullptr ? chunk->m_next->m_prev : m_tail) = chunk->m_prev;
+        delete chunk;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    void SortedList<T, Compare, ChunkedStorage<CacheLines>>::clear() noexcept {
+        while (m_head != nullptr) {
+            destroyChunk(m_head);
+        }
+        m_size = 0;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    void SortedList<T, Compare, ChunkedStorage<CacheLines>>::pushBack(T&& data) {
+        Chunk* chunk = m_tail;
+        if (chunk == nullptr || chunk->m_count == CHUNK_CAPACITY) {
+            chunk = createChunkAfter(m_tail);
+        }
+        new (&chunk->m_slots[chunk->m_count]) T(std::move(data));
+        chunk->m_count++;
+        m_size++;
+    }
+
+    template <typename T, typename Compare, std::size_t CacheLines>
+    void SortedList<T, Compare, ChunkedStorage<CacheLines>>::insertValue(T&& data) {
+        // skip the chunks whose last element data doesn't come before, only one element per chunk is read
+        Chunk* chunk = m_head;
+        while (chunk != nullptr && chunk->m_next != nullptr && !m_compare(data, *chunk->at(chunk->m_count - 1))) {
+            chunk = chunk->m_next;
+        }
+        if (chunk == nullptr) {
+            pushBack(std::move(data));
+            return;
+        }
+
+        // binary search for the first element that data comes before - equal elements keep their order
+        std::size_t low = 0;
+        std::size_t high = chunk->m_count;
+        while (low < high) {
+            const std::size_t middle = (low + high) / 2;
+            if (m_compare(data, *chunk->at(middle))) {
+                high = middle;
+            }
+            else {
+                low = middle + 1;
+            }
+        }
+        std::size_t index = low;
+
+        if (chunk->m_count == CHUNK_CAPACITY) {
+            if (index == CHUNK_CAPACITY) { // after the last element of the list, start a new chunk
+                pushBack(std::move(data));
+                return;
+            }
+            // split the chunk in two and continue in the half where data belongs
+            Chunk* upper = createChunkAfter(chunk);
+            const std::size_t keep = CHUNK_CAPACITY / 2;
+            for (std::size_t i = keep; i < CHUNK_CAPACITY; ++i) {
+                new (&upper->m_slots[i - keep]) T(std::move(*chunk->at(i)));
+                chunk->at(i)->~T();
+            }
+            upper->m_count = CHUNK_CAPACITY - keep;
+            chunk->m_count = keep;
+            if (index > keep) {
+                chunk = upper;
+                index -= keep;
+            }
+        }
+
+        chunk->openGap(index);
+        new (&chunk->m_slots[index]) T(std::move(data));
+        chunk->m_count++;
+        m_size++;
+    }
+}
@@ -0,0 +1,147 @@
+#include "ConcurrentTaskManager.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+ConcurrentTaskManager::ConcurrentTaskManager(std::size_t numOfShards, std::size_t maxPersons)
+    : m_shards(new Shard[numOfShards > 0 ? numOfShards : 1]), m_numOfShards(numOfShards > 0 ? numOfShards : 1),
+      m_maxPersons(maxPersons), m_numOfPersons(0), m_nextOrder(0), m_newestTaskId(0) {}
+
+void ConcurrentTaskManager::assignTask(const string &personName, const Task &task) {
+    Task newTask = task;
+    newTask.setId(m_newestTaskId.fetch_add(1, std::memory_order_relaxed));
+
+    Shard& shard = shardOf(personName);
+    std::lock_guard<std::mutex> lock(shard.m_mutex);
+    findOrAddPerson(shard, personName).assignTask(std::move(newTask));
+}
+
+void ConcurrentTaskManager::completeTask(const string &personName) {
+    Shard& shard = shardOf(personName);
+    std::lock_guard<std::mutex> lock(shard.m_mutex);
+    const auto found = shard.m_employees.find(personName);
+    if (found != shard.m_employees.end()) { // if the person exists...
+        found->second.m_person.completeTask();
+    }
+}
+
+void ConcurrentTaskManager::bumpPriorityByType(TaskType type, int priority) {
+    if (priority > 0) {
+        const auto locks = lockAllShards();
+        for (std::size_t i = 0; i < m_numOfShards; ++i) {
+            for (auto& employee : m_shards[i].m_employees) {
+                employee.second.m_person.updateTasks([&type](const Task& curTask) -> bool {
+                    return curTask.getType() == type;
+                }, [&priority](const Task& curTask) -> Task {
+                    Task newTask(curTask.getPriority() + priority, curTask.getType(), curTask.getInternedDescription());
+                    newTask.setId(curTask.getId());
+                    return newTask;
+                });
+            }
+        }
+    }
+}
+
+void ConcurrentTaskManager::printAllEmployees() const {
+    printAllEmployees(std::cout);
+}
+
+void ConcurrentTaskManager::printAllEmployees(ostream &os) const {
+    std::vector<std::pair<unsigned long long, Person>> employees;
+    {
+        const auto locks = lockAllShards();
+        for (std::size_t i = 0; i < m_numOfShards; ++i) {
+            for (const auto& employee : m_shards[i].m_employees) {
+                employees.emplace_back(employee.second.m_order, employee.second.m_person);
+            }
+        }
+    }
+    std::sort(employees.begin(), employees.end(), [](const std::pair<unsigned long long, Person>& lhs,
+                                                     const std::pair<unsigned long long, Person>& rhs) {
+        return lhs.first < rhs.first;
+    });
+    for (const auto& employee : employees) {
+        os << employee.second << '\n';
+    }
+    os.flush();
+}
+
+void ConcurrentTaskManager::printTasksByType(TaskType type) const {
+    printTasksByType(type, std::cout);
+}
+
+void ConcurrentTaskManager::printTasksByType(TaskType type, ostream &os) const {
+    const std::vector<Task> tasks = copyAllTasks();
+    const SortedList<Task> allTasks(tasks.begin(), tasks.end());
+    for (const Task& curTask : allTasks.filtered([&type](const Task& curTask) -> bool {
+        return curTask.getType() == type;
+    })) {
+        os << curTask << '\n';
+    }
+    os.flush();
+}
+
+void ConcurrentTaskManager::printAllTasks() const {
+    printAllTasks(std::cout);
+}
+
+void ConcurrentTaskManager::printAllTasks(ostream &os) const {
+    const std::vector<Task> tasks = copyAllTasks();
+    for (const Task& curTask : SortedList<Task>(tasks.begin(), tasks.end())) {
+        os << curTask << '\n';
+    }
+    os.flush();
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+ConcurrentTaskManager::Shard& ConcurrentTaskManager::shardOf(const string &personName) const {
+    return m_shards[std::hash<string>()(personName) % m_numOfShards];
+}
+
+Person& ConcurrentTaskManager::findOrAddPerson(Shard& shard, const string &personName) {
+    const auto found = shard.m_employees.find(personName);
+    if (found != shard.m_employees.end()) {
+        return found->second.m_person;
+    }
+
+    // take a place for the new person first, other shards may be adding persons at the same time
+    std::size_t numOfPersons = m_numOfPersons.load(std::memory_order_relaxed);
+    do {
+        if (numOfPersons >= m_maxPersons) {
+            throw std::runtime_error("Max number of people reached");
+        }
+    } while (!m_numOfPersons.compare_exchange_weak(numOfPersons, numOfPersons + 1, std::memory_order_relaxed));
+    try {
+        Employee newEmployee{Person(personName), m_nextOrder.fetch_add(1, std::memory_order_relaxed)};
+        return shard.m_employees.emplace(personName, std::move(newEmployee)).first->second.m_person;
+    }
+    catch (...) {
+        m_numOfPersons.fetch_sub(1, std::memory_order_relaxed);
+        throw;
+    }
+}
+
+std::vector<std::unique_lock<std::mutex>> ConcurrentTaskManager::lockAllShards() const {
+    // always in the same order, so two threads locking everything can't wait for each other
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(m_numOfShards);
+    for (std::size_t i = 0; i < m_numOfShards; ++i) {
+        locks.emplace_back(m_shards[i].m_mutex);
+    }
+    return locks;
+}
+
+std::vector<Task> ConcurrentTaskManager::copyAllTasks() const {
+    std::vector<Task> allTasks;
+    const auto locks = lockAllShards();
+    for (std::size_t i = 0; i < m_numOfShards; ++i) {
+        for (const auto& employee : m_shards[i].m_employees) {
+            for (const Task& curTask : employee.second.m_person.getTasks()) {
+                allTasks.push_back(curTask);
+            }
+        }
+    }
+    return allTasks;
+}
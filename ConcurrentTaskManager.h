@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Person.h"
+#include "SortedList.h"
+#include "Task.h"
+
+/**
+ * @brief Thread-safe version of TaskManager, for many threads assigning and completing tasks at once.
+ *
+ * Persons are spread over shards by the hash of their name, and every shard has its own lock, so operations
+ * on persons in different shards never wait for each other. Task IDs come from an atomic counter - they are
+ * unique and increasing in the order the calls started, but two threads assigning at once may reach their
+ * persons in either order.
+ *
+ * Operations that touch every person (bumpPriorityByType and the print methods) lock all the shards, always in
+ * the same order, so each of them sees and changes a consistent state - as if no other operation ran during
+ * it. The print methods only hold the locks while copying what they print, never while writing the output.
+ */
+class ConcurrentTaskManager {
+private:
+    struct Employee {
+        Person m_person;
+        unsigned long long m_order; // when the person was added, for printing in the order they were added
+    };
+
+    struct alignas(64) Shard { // every lock on its own cache line
+        std::mutex m_mutex;
+        std::unordered_map<string, Employee> m_employees;
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    std::size_t m_numOfShards;
+    std::size_t m_maxPersons;
+    std::atomic<std::size_t> m_numOfPersons;
+    std::atomic<unsigned long long> m_nextOrder;
+    std::atomic<TaskId> m_newestTaskId;
+
+    Shard& shardOf(const string& personName) const;
+    Person& findOrAddPerson(Shard& shard, const string& personName);
+    std::vector<std::unique_lock<std::mutex>> lockAllShards() const;
+    std::vector<Task> copyAllTasks() const;
+
+public:
+    /**
+     * @brief Number of shards a default constructed ConcurrentTaskManager uses.
+     */
+    static const std::size_t DEFAULT_SHARDS = 64;
+
+    /**
+     * @brief Capacity that lets the ConcurrentTaskManager hold any number of persons.
+     */
+    static const std::size_t UNLIMITED_PERSONS = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * @brief Constructor to create a ConcurrentTaskManager object.
+     *
+     * @param numOfShards The number of independently locked shards, more shards means less waiting.
+     * @param maxPersons The maximum number of persons, or UNLIMITED_PERSONS for no limit.
+     */
+    explicit ConcurrentTaskManager(std::size_t numOfShards = DEFAULT_SHARDS,
+                                   std::size_t maxPersons = UNLIMITED_PERSONS);
+
+    /**
+     * @brief Deleted copy constructor to prevent copying of ConcurrentTaskManager objects.
+     */
+    ConcurrentTaskManager(const ConcurrentTaskManager &other) = delete;
+
+    /**
+     * @brief Deleted copy assignment operator to prevent assignment of ConcurrentTaskManager objects.
+     */
+    ConcurrentTaskManager &operator=(const ConcurrentTaskManager &other) = delete;
+
+    /**
+     * @brief Assigns a task to a person. Only locks the shard of the person.
+     *
+     * @param personName The name of the person to whom the task will be assigned.
+     * @param task The task to be assigned.
+     * @throw std::runtime_error If the person is new and the maximum number of persons was reached.
+     */
+    void assignTask(const string &personName, const Task &task);
+
+    /**
+     * @brief Completes the highest priority task assigned to a person. Only locks the shard of the person.
+     *
+     * @param personName The name of the person who will complete the task.
+     * @throw std::runtime_error If the person exists and has no tasks.
+     */
+    void completeTask(const string &personName);
+
+    /**
+     * @brief Bumps the priority of all tasks of a specific type, of all persons at once.
+     *
+     * @param type The type of tasks whose priority will be bumped.
+     * @param priority The amount by which the priority will be increased.
+     */
+    void bumpPriorityByType(TaskType type, int priority);
+
+    /**
+     * @brief Prints all employees and their tasks, in the order the employees were added.
+     */
+    void printAllEmployees() const;
+
+    /**
+     * @brief Prints all employees and their tasks to the given stream, in the order they were added, and flushes
+     * it once at the end.
+     *
+     * @param os The output stream.
+     */
+    void printAllEmployees(ostream &os) const;
+
+    /**
+     * @brief Prints all tasks of a specific type.
+     *
+     * @param type The type of tasks to be printed.
+     */
+    void printTasksByType(TaskType type) const;
+
+    /**
+     * @brief Prints all tasks of a specific type to the given stream, flushing it once at the end.
+     *
+     * @param type The type of tasks to be printed.
+     * @param os The output stream.
+     */
+    void printTasksByType(TaskType type, ostream &os) const;
+
+    /**
+     * @brief Prints all tasks assigned to all employees.
+     */
+    void printAllTasks() const;
+
+    /**
+     * @brief Prints all tasks assigned to all employees to the given stream, flushing it once at the end.
+     *
+     * @param os The output stream.
+     */
+    void printAllTasks(ostream &os) const;
+};
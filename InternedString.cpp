@@ -0,0 +1,104 @@
+#include "InternedString.h"
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// the entries are never moved, so the keys can point at their texts
+struct InternedString::Pool {
+    std::mutex m_mutex;
+    std::unordered_map<std::string_view, Entry*> m_entries;
+};
+
+InternedString::InternedString() noexcept : m_entry(nullptr) {}
+
+InternedString::InternedString(std::string_view text) : m_entry(nullptr) {
+    if (text.empty()) {
+        return;
+    }
+    Pool& entries = pool();
+    std::lock_guard<std::mutex> lock(entries.m_mutex);
+    const auto found = entries.m_entries.find(text);
+    if (found != entries.m_entries.end()) {
+        found->second->m_references.fetch_add(1, std::memory_order_relaxed);
+        m_entry = found->second;
+        return;
+    }
+    Entry* newEntry = new Entry{std::string(text), {1}};
+    try {
+        entries.m_entries.emplace(newEntry->m_text, newEntry);
+    }
+    catch (...) {
+        delete newEntry;
+        throw;
+    }
+    m_entry = newEntry;
+}
+
+InternedString::InternedString(const InternedString& other) noexcept : m_entry(other.m_entry) {
+    if (m_entry != nullptr) { // the other handle keeps the entry alive, so no lock is needed
+        m_entry->m_references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+InternedString::InternedString(InternedString&& other) noexcept : m_entry(other.m_entry) {
+    other.m_entry = nullptr;
+}
+
+InternedString& InternedString::operator=(const InternedString& other) noexcept {
+    InternedString copy(other);
+    std::swap(m_entry, copy.m_entry);
+    return *this;
+}
+
+InternedString& InternedString::operator=(InternedString&& other) noexcept {
+    std::swap(m_entry, other.m_entry);
+    return *this;
+}
+
+InternedString::~InternedString() {
+    release();
+}
+
+const std::string& InternedString::str() const noexcept {
+    return m_entry != nullptr ? m_entry->m_text : emptyText();
+}
+
+std::size_t InternedString::poolSize() {
+    Pool& entries = pool();
+    std::lock_guard<std::mutex> lock(entries.m_mutex);
+    return entries.m_entries.size();
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+InternedString::Pool& InternedString::pool() {
+    static Pool* const instance = new Pool(); // outlives every handle, including the ones in static objects
+    return *instance;
+}
+
+const std::string& InternedString::emptyText() noexcept {
+    static const std::string empty;
+    return empty;
+}
+
+void InternedString::release() noexcept {
+    if (m_entry == nullptr) {
+        return;
+    }
+    // dropping a reference that isn't the last one doesn't need the lock
+    std::size_t references = m_entry->m_references.load(std::memory_order_relaxed);
+    while (references > 1) {
+        if (m_entry->m_references.compare_exchange_weak(references, references - 1, std::memory_order_acq_rel)) {
+            m_entry = nullptr;
+            return;
+        }
+    }
+    // the last reference is only dropped under the lock, so the entry can't be found and revived meanwhile
+    Pool& entries = pool();
+    std::lock_guard<std::mutex> lock(entries.m_mutex);
+    if (m_entry->m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        entries.m_entries.erase(m_entry->m_text);
+        delete m_entry;
+    }
+    m_entry = nullptr;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Handle to a string kept once in a process-wide pool, shared by every handle with the same text.
+ *
+ * Creating a handle looks the text up in the pool and only stores it if it isn't there yet, so many tasks with
+ * the same description share one copy of it. Copying a handle copies a pointer and counts a reference, and the
+ * text leaves the pool with its last handle. Handles can be created, copied and destroyed from any thread.
+ *
+ * The empty string has no entry in the pool.
+ */
+class InternedString {
+private:
+    struct Entry {
+        std::string m_text;
+        std::atomic<std::size_t> m_references;
+    };
+
+    struct Pool;
+
+    Entry* m_entry;
+
+    static Pool& pool();
+    static const std::string& emptyText() noexcept;
+    void release() noexcept;
+
+public:
+    /**
+     * @brief Creates a handle to the empty string.
+     */
+    InternedString() noexcept;
+
+    /**
+     * @brief Creates a handle to the pool's copy of a text, adding the text to the pool if it isn't there yet.
+     *
+     * @param text The text to be interned.
+     */
+    explicit InternedString(std::string_view text);
+
+    InternedString(const InternedString& other) noexcept;
+
+    InternedString(InternedString&& other) noexcept;
+
+    InternedString& operator=(const InternedString& other) noexcept;
+
+    InternedString& operator=(InternedString&& other) noexcept;
+
+    ~InternedString();
+
+    /**
+     * @brief The text of the handle, valid as long as the handle or a copy of it exists.
+     */
+    const std::string& str() const noexcept;
+
+    /**
+     * @brief The number of distinct texts in the pool.
+     */
+    static std::size_t poolSize();
+
+    /**
+     * @brief Two handles are equal if they have the same text - for interned strings that is the same entry.
+     */
+    friend bool operator==(const InternedString& lhs, const InternedString& rhs) noexcept {
+        return lhs.m_entry == rhs.m_entry;
+    }
+
+    friend bool operator!=(const InternedString& lhs, const InternedString& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
@@ -0,0 +1,550 @@
+#include "JournaledTaskManager.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JOURNAL_FSYNC
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Journal layout, in the byte order of the machine that wrote it:
+//   header  - magic, version and the checksum of the snapshot the journal continues
+//   records - each one the size of its body, the checksum of its body, and the body: an operation and its arguments
+// Records are only ever appended. Opening the journal drops a record that was cut off or doesn't match its checksum,
+// along with everything after it.
+
+namespace {
+    const char JOURNAL_MAGIC[8] = {'M', 'T', 'M', 'J', 'R', 'N', 'L', '\0'};
+    const std::uint32_t JOURNAL_VERSION = 1;
+
+    struct JournalHeader {
+        char m_magic[8];
+        std::uint32_t m_version;
+        std::uint32_t m_reserved;
+        std::uint64_t m_snapshot;
+    };
+
+    struct RecordHeader {
+        std::uint32_t m_size;
+        std::uint32_t m_checksum;
+    };
+
+    enum class Operation : std::uint8_t {
+        RegisterPerson = 1,
+        AssignTask,
+        AssignTaskById,
+        AssignTasks,
+        AssignBatch,
+        CompleteTask,
+        CompleteTaskById,
+        CompleteTaskOfId,
+        CancelTask,
+        BumpPriorityByType,
+        Compaction // changes nothing, marks a journal that compaction is about to replace
+    };
+
+    // FNV-1a, folded to 32 bits
+    std::uint32_t checksum(const char* data, std::size_t size) {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+    }
+
+    void corrupt(const string& path) {
+        throw std::runtime_error("Journal " + path + " is corrupt");
+    }
+
+    // ------------------------------ encoding ------------------------------ //
+
+    template <typename Value>
+    void put(std::vector<char>& buffer, const Value& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(Value));
+    }
+
+    void putString(std::vector<char>& buffer, const string& text) {
+        put(buffer, static_cast<std::uint32_t>(text.size()));
+        buffer.insert(buffer.end(), text.begin(), text.end());
+    }
+
+    void putTask(std::vector<char>& buffer, const Task& task) { // the ID is left out, it is given when assigned
+        put(buffer, static_cast<std::uint8_t>(task.getPriority()));
+        put(buffer, static_cast<std::uint8_t>(task.getType()));
+        putString(buffer, task.getDescription());
+    }
+
+    /**
+     * @brief Reads the arguments of a record back, in the order they were put.
+     */
+    class RecordReader {
+        const char* m_data;
+        std::size_t m_size;
+        std::size_t m_position;
+
+        const char* take(std::size_t size) {
+            if (size > m_size - m_position) {
+                throw std::runtime_error("Journal record is corrupt");
+            }
+            const char* taken = m_data + m_position;
+            m_position += size;
+            return taken;
+        }
+
+    public:
+        RecordReader(const char* data, std::size_t size) : m_data(data), m_size(size), m_position(0) {}
+
+        template <typename Value>
+        Value get() {
+            Value value;
+            std::memcpy(&value, take(sizeof(Value)), sizeof(Value));
+            return value;
+        }
+
+        string getString() {
+            const std::uint32_t size = get<std::uint32_t>();
+            return string(take(size), size);
+        }
+
+        Task getTask() {
+            const int priority = get<std::uint8_t>();
+            const std::uint8_t type = get<std::uint8_t>();
+            if (type > static_cast<std::uint8_t>(TaskType::General)) {
+                throw std::runtime_error("Journal record is corrupt");
+            }
+            return Task(priority, static_cast<TaskType>(type), getString());
+        }
+
+        template <typename Value>
+        std::vector<Value> getVector(Value (RecordReader::*getOne)()) {
+            const std::uint32_t size = get<std::uint32_t>();
+            std::vector<Value> values;
+            values.reserve(std::min<std::size_t>(size, m_size - m_position));
+            for (std::uint32_t i = 0; i < size; ++i) {
+                values.push_back((this->*getOne)());
+            }
+            return values;
+        }
+
+        std::pair<string, Task> getAssignment() {
+            string personName = getString();
+            return std::pair<string, Task>(std::move(personName), getTask());
+        }
+
+        void finish() const { // every argument was read, and nothing is left over
+            if (m_position != m_size) {
+                throw std::runtime_error("Journal record is corrupt");
+            }
+        }
+    };
+
+    // -------------------------------- files -------------------------------- //
+
+    void syncFile(const string& path) {
+#ifdef JOURNAL_FSYNC
+        const int file = ::open(path.c_str(), O_RDONLY);
+        const bool synced = file >= 0 && ::fsync(file) == 0;
+        if (file >= 0) {
+            ::close(file);
+        }
+        if (!synced) {
+            throw std::runtime_error("Can't sync " + path);
+        }
+#else
+        (void)path;
+#endif
+    }
+
+    void syncDirectoryOf(const string& path) { // makes a rename in the directory last
+        const std::size_t slash = path.find_last_of('/');
+        syncFile(slash == string::npos ? string(".") : path.substr(0, slash == 0 ? 1 : slash));
+    }
+
+    bool exists(const string& path) {
+        return std::ifstream(path).good();
+    }
+
+    /**
+     * @brief Replaces a journal with a new one that has a header and the given records, all or nothing.
+     */
+    void writeJournal(const string& path, std::uint64_t snapshot, const char* records, std::size_t size) {
+        JournalHeader header = {};
+        std::memcpy(header.m_magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        header.m_version = JOURNAL_VERSION;
+        header.m_snapshot = snapshot;
+
+        const string tempPath = path + ".tmp";
+        std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+        bool written = file != nullptr
+                       && std::fwrite(&header, sizeof(header), 1, file) == 1
+                       && (size == 0 || std::fwrite(records, 1, size, file) == size)
+                       && std::fflush(file) == 0;
+#ifdef JOURNAL_FSYNC
+        written = written && ::fsync(::fileno(file)) == 0;
+#endif
+        if (file != nullptr && std::fclose(file) != 0) {
+            written = false;
+        }
+        if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Can't write journal " + path);
+        }
+        syncDirectoryOf(path);
+    }
+}
+
+JournaledTaskManager::JournaledTaskManager(const string &snapshotPath, const string &journalPath,
+                                           JournalOptions options, std::size_t maxPersons)
+    : m_manager(maxPersons), m_snapshotPath(snapshotPath), m_journalPath(journalPath), m_options(options),
+      m_snapshot(0), m_journal(nullptr), m_committedSize(0), m_broken(false), m_numOfPending(0) {
+    if (exists(m_snapshotPath)) {
+        m_snapshot = m_manager.loadSnapshot(m_snapshotPath);
+    }
+    else {
+        if (exists(m_journalPath)) {
+            throw std::runtime_error("Journal " + m_journalPath + " continues a snapshot that is missing");
+        }
+        // a journal always continues a snapshot, which also keeps the maximum number of persons
+        m_snapshot = m_manager.saveSnapshot(m_snapshotPath);
+        syncDirectoryOf(m_snapshotPath);
+    }
+    recover();
+    openJournal();
+}
+
+JournaledTaskManager::~JournaledTaskManager() {
+    try {
+        commit();
+    }
+    catch (...) { // nothing can be reported from here, the uncommitted group is lost as in a crash
+    }
+    if (m_journal != nullptr) {
+        std::fclose(m_journal);
+    }
+}
+
+const TaskManager &JournaledTaskManager::manager() const {
+    return m_manager;
+}
+
+PersonId JournaledTaskManager::registerPerson(const string &personName) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::RegisterPerson));
+    putString(m_pending, personName);
+    return static_cast<PersonId>(finishRecord(record));
+}
+
+void JournaledTaskManager::assignTask(const string &personName, const Task &task) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::AssignTask));
+    putString(m_pending, personName);
+    putTask(m_pending, task);
+    finishRecord(record);
+}
+
+void JournaledTaskManager::assignTask(PersonId personId, const Task &task) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::AssignTaskById));
+    put(m_pending, personId);
+    putTask(m_pending, task);
+    finishRecord(record);
+}
+
+void JournaledTaskManager::assignTasks(const string &personName, const std::vector<Task> &tasks) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::AssignTasks));
+    putString(m_pending, personName);
+    put(m_pending, static_cast<std::uint32_t>(tasks.size()));
+    for (const Task& curTask : tasks) {
+        putTask(m_pending, curTask);
+    }
+    finishRecord(record);
+}
+
+void JournaledTaskManager::assignTasks(const std::vector<std::pair<string, Task>> &tasks) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::AssignBatch));
+    put(m_pending, static_cast<std::uint32_t>(tasks.size()));
+    for (const std::pair<string, Task>& curTask : tasks) {
+        putString(m_pending, curTask.first);
+        putTask(m_pending, curTask.second);
+    }
+    finishRecord(record);
+}
+
+void JournaledTaskManager::completeTask(const string &personName) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::CompleteTask));
+    putString(m_pending, personName);
+    finishRecord(record);
+}
+
+void JournaledTaskManager::completeTask(PersonId personId) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::CompleteTaskOfId));
+    put(m_pending, personId);
+    finishRecord(record);
+}
+
+void JournaledTaskManager::completeTaskById(TaskId id) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::CompleteTaskById));
+    put(m_pending, id);
+    finishRecord(record);
+}
+
+bool JournaledTaskManager::cancelTask(TaskId id) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::CancelTask));
+    put(m_pending, id);
+    return finishRecord(record) != 0;
+}
+
+void JournaledTaskManager::bumpPriorityByType(TaskType type, int priority) {
+    const std::size_t record = beginRecord(static_cast<std::uint8_t>(Operation::BumpPriorityByType));
+    put(m_pending, static_cast<std::uint8_t>(type));
+    put(m_pending, static_cast<std::int32_t>(priority));
+    finishRecord(record);
+}
+
+void JournaledTaskManager::commit() {
+    if (m_pending.empty()) {
+        return;
+    }
+    if (m_broken) {
+        throw std::runtime_error("Journal " + m_journalPath + " ends with a partly written group, reopen it to recover");
+    }
+    if (m_journal == nullptr) {
+        startJournal();
+    }
+    bool written = std::fwrite(m_pending.data(), 1, m_pending.size(), m_journal) == m_pending.size()
+                   && std::fflush(m_journal) == 0;
+#ifdef JOURNAL_FSYNC
+#ifdef __APPLE__
+    written = written && ::fsync(::fileno(m_journal)) == 0;
+#else
+    written = written && ::fdatasync(::fileno(m_journal)) == 0; // the size changes are synced, the times aren't
+#endif
+#endif
+    if (!written) {
+        // the group stays pending and is written whole by the next commit, so none of it may stay in the file
+        std::clearerr(m_journal);
+#ifdef JOURNAL_FSYNC
+        m_broken = ::ftruncate(::fileno(m_journal), m_committedSize) != 0;
+#else
+        m_broken = true;
+#endif
+        throw std::runtime_error("Can't write journal " + m_journalPath);
+    }
+    m_committedSize += static_cast<long>(m_pending.size());
+    m_pending.clear();
+    m_numOfPending = 0;
+}
+
+void JournaledTaskManager::compact() {
+    // the old journal is marked before the snapshot is replaced, so after a crash in between, opening the files
+    // knows the old journal is part of the new snapshot
+    sealRecord(beginRecord(static_cast<std::uint8_t>(Operation::Compaction)));
+    commit();
+    const std::uint64_t snapshot = m_manager.saveSnapshot(m_snapshotPath);
+
+    // the old journal is part of the snapshot now, so nothing may be committed to it anymore - it is let go before
+    // anything else can fail, and whatever fails next is retried by the next commit
+    std::fclose(m_journal);
+    m_journal = nullptr;
+    m_snapshot = snapshot;
+    startJournal();
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+void JournaledTaskManager::recover() {
+    std::vector<char> journal;
+    {
+        std::ifstream file(m_journalPath, std::ios::binary);
+        if (!file) { // a new journal
+            writeJournal(m_journalPath, m_snapshot, nullptr, 0);
+            return;
+        }
+        journal.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    JournalHeader header;
+    if (journal.size() < sizeof(header)) {
+        corrupt(m_journalPath);
+    }
+    std::memcpy(&header, journal.data(), sizeof(header));
+    if (std::memcmp(header.m_magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+        throw std::runtime_error(m_journalPath + " is not a journal");
+    }
+    if (header.m_version != JOURNAL_VERSION) {
+        throw std::runtime_error("Journal " + m_journalPath + " has an unsupported version");
+    }
+    // the records that were written whole - a crash can only have cut off the last one
+    std::vector<std::pair<const char*, std::uint32_t>> records;
+    std::size_t position = sizeof(header);
+    while (journal.size() - position >= sizeof(RecordHeader)) {
+        RecordHeader record;
+        std::memcpy(&record, journal.data() + position, sizeof(record));
+        const char* body = journal.data() + position + sizeof(record);
+        if (record.m_size == 0 || record.m_size > journal.size() - position - sizeof(record)
+            || checksum(body, record.m_size) != record.m_checksum) {
+            break; // cut off by a crash
+        }
+        records.emplace_back(body, record.m_size);
+        position += sizeof(record) + record.m_size;
+    }
+
+    if (header.m_snapshot != m_snapshot) {
+        // compaction marks the old journal before it replaces the snapshot, so a journal that ends with the mark is
+        // already part of the snapshot - any other journal belongs to a different snapshot, and can't be replayed
+        if (records.empty() || static_cast<Operation>(records.back().first[0]) != Operation::Compaction) {
+            throw std::runtime_error("Journal " + m_journalPath + " doesn't continue snapshot " + m_snapshotPath);
+        }
+        writeJournal(m_journalPath, m_snapshot, nullptr, 0);
+        return;
+    }
+    for (const std::pair<const char*, std::uint32_t>& record : records) {
+        try {
+            apply(record.first, record.second);
+        }
+        catch (const std::runtime_error&) { // the original call threw the same way, after the same changes
+        }
+    }
+    if (position != journal.size()) { // new records must not follow a broken one
+        writeJournal(m_journalPath, m_snapshot, journal.data() + sizeof(header), position - sizeof(header));
+    }
+}
+
+void JournaledTaskManager::startJournal() {
+    // the new snapshot has to be in place for good before the journal that continues it replaces the old one
+    syncDirectoryOf(m_snapshotPath);
+    writeJournal(m_journalPath, m_snapshot, nullptr, 0);
+    openJournal();
+}
+
+void JournaledTaskManager::openJournal() {
+    m_journal = std::fopen(m_journalPath.c_str(), "ab");
+    // unbuffered, so a failed commit leaves nothing behind to be written later, and appends follow a truncation
+    if (m_journal == nullptr || std::setvbuf(m_journal, nullptr, _IONBF, 0) != 0
+        || std::fseek(m_journal, 0, SEEK_END) != 0 || (m_committedSize = std::ftell(m_journal)) < 0) {
+        if (m_journal != nullptr) {
+            std::fclose(m_journal);
+            m_journal = nullptr;
+        }
+        throw std::runtime_error("Can't open journal " + m_journalPath);
+    }
+    m_broken = false;
+}
+
+std::size_t JournaledTaskManager::beginRecord(std::uint8_t operation) {
+    const std::size_t record = m_pending.size();
+    put(m_pending, RecordHeader{0, 0});
+    put(m_pending, operation);
+    return record;
+}
+
+void JournaledTaskManager::sealRecord(std::size_t record) {
+    const char* body = m_pending.data() + record + sizeof(RecordHeader);
+    const std::size_t size = m_pending.size() - record - sizeof(RecordHeader);
+    const RecordHeader header = {static_cast<std::uint32_t>(size), checksum(body, size)};
+    std::memcpy(m_pending.data() + record, &header, sizeof(header));
+    if (m_numOfPending++ == 0) {
+        m_oldestPending = std::chrono::steady_clock::now();
+    }
+}
+
+std::int64_t JournaledTaskManager::finishRecord(std::size_t record) {
+    sealRecord(record);
+    const char* body = m_pending.data() + record + sizeof(RecordHeader);
+    const std::size_t size = m_pending.size() - record - sizeof(RecordHeader);
+
+    // the record is applied whether the call throws or not, just like it will be on replay
+    std::int64_t result = 0;
+    try {
+        result = apply(body, size);
+    }
+    catch (...) {
+        if (m_numOfPending >= m_options.m_groupSize) {
+            commit();
+        }
+        throw;
+    }
+    if (m_numOfPending >= m_options.m_groupSize
+        || std::chrono::steady_clock::now() - m_oldestPending >= m_options.m_groupInterval) {
+        commit();
+    }
+    return result;
+}
+
+std::int64_t JournaledTaskManager::apply(const char* body, std::size_t size) {
+    RecordReader reader(body, size);
+    switch (static_cast<Operation>(reader.get<std::uint8_t>())) {
+        case Operation::RegisterPerson: {
+            const string personName = reader.getString();
+            reader.finish();
+            return m_manager.registerPerson(personName);
+        }
+        case Operation::AssignTask: {
+            const string personName = reader.getString();
+            const Task task = reader.getTask();
+            reader.finish();
+            m_manager.assignTask(personName, task);
+            return 0;
+        }
+        case Operation::AssignTaskById: {
+            const PersonId personId = reader.get<PersonId>();
+            const Task task = reader.getTask();
+            reader.finish();
+            m_manager.assignTask(personId, task);
+            return 0;
+        }
+        case Operation::AssignTasks: {
+            const string personName = reader.getString();
+            const std::vector<Task> tasks = reader.getVector(&RecordReader::getTask);
+            reader.finish();
+            m_manager.assignTasks(personName, tasks);
+            return 0;
+        }
+        case Operation::AssignBatch: {
+            const std::vector<std::pair<string, Task>> tasks = reader.getVector(&RecordReader::getAssignment);
+            reader.finish();
+            m_manager.assignTasks(tasks);
+            return 0;
+        }
+        case Operation::CompleteTask: {
+            const string personName = reader.getString();
+            reader.finish();
+            m_manager.completeTask(personName);
+            return 0;
+        }
+        case Operation::CompleteTaskOfId: {
+            const PersonId personId = reader.get<PersonId>();
+            reader.finish();
+            m_manager.completeTask(personId);
+            return 0;
+        }
+        case Operation::CompleteTaskById: {
+            const TaskId id = reader.get<TaskId>();
+            reader.finish();
+            m_manager.completeTaskById(id);
+            return 0;
+        }
+        case Operation::CancelTask: {
+            const TaskId id = reader.get<TaskId>();
+            reader.finish();
+            return m_manager.cancelTask(id) ? 1 : 0;
+        }
+        case Operation::BumpPriorityByType: {
+            const std::uint8_t type = reader.get<std::uint8_t>();
+            const std::int32_t priority = reader.get<std::int32_t>();
+            reader.finish();
+            if (type > static_cast<std::uint8_t>(TaskType::General)) {
+                throw std::runtime_error("Journal record is corrupt");
+            }
+            m_manager.bumpPriorityByType(static_cast<TaskType>(type), priority);
+            return 0;
+        }
+        case Operation::Compaction: {
+            reader.finish();
+            return 0;
+        }
+    }
+    throw std::runtime_error("Journal record is corrupt");
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+#include "Task.h"
+#include "TaskManager.h"
+
+/**
+ * @brief When the journal of a JournaledTaskManager is written to disk.
+ *
+ * Changes are kept in memory and written and synced together, once there are m_groupSize of them or the oldest of
+ * them has waited m_groupInterval - whichever comes first. A group size of 1 syncs every change on its own.
+ */
+struct JournalOptions {
+    std::size_t m_groupSize = 64;
+    std::chrono::microseconds m_groupInterval = std::chrono::milliseconds(5);
+};
+
+/**
+ * @brief TaskManager whose changes survive a restart, kept in a snapshot file and a write-ahead journal.
+ *
+ * Every change is recorded in the journal before it is made, and is then made by reading the record back, so
+ * replaying the journal runs exactly what the original call ran and ends with the same persons, tasks and task
+ * IDs. That includes calls that threw, like assigning to a new person when the maximum was reached, which still
+ * uses up a task ID.
+ *
+ * Records are committed in groups, see JournalOptions. The group interval is checked whenever a change is made,
+ * and commit() commits at any time. A crash loses at most the group that wasn't committed yet, and a record that
+ * was only partly written is dropped when the journal is opened again.
+ *
+ * compact() saves the whole state as a new snapshot and starts an empty journal on top of it. The journal keeps
+ * the checksum of the snapshot it was started on, and compaction marks the old journal before replacing the
+ * snapshot - so after a crash between the two steps the old journal is recognized as already being part of the new
+ * snapshot, while a journal that doesn't belong to its snapshot at all is refused.
+ *
+ * Like TaskManager, it is meant to be used by one thread at a time.
+ */
+class JournaledTaskManager {
+private:
+    TaskManager m_manager;
+    string m_snapshotPath;
+    string m_journalPath;
+    JournalOptions m_options;
+    std::uint64_t m_snapshot; // the checksum of the snapshot the journal continues
+    std::FILE* m_journal;     // null after the snapshot was replaced but its journal couldn't be started
+    long m_committedSize;     // the size of the journal up to the last group that was committed whole
+    bool m_broken;            // a group was partly written and couldn't be cut off again
+
+    // records not committed yet, and when the oldest of them was made
+    std::vector<char> m_pending;
+    std::size_t m_numOfPending;
+    std::chrono::steady_clock::time_point m_oldestPending;
+
+    void recover();
+    void openJournal();
+    void startJournal();
+    std::size_t beginRecord(std::uint8_t operation);
+    void sealRecord(std::size_t record);
+    std::int64_t finishRecord(std::size_t record);
+    std::int64_t apply(const char* body, std::size_t size);
+
+public:
+    /**
+     * @brief Opens a journaled TaskManager, loading the snapshot and replaying the journal on top of it.
+     *
+     * If neither file exists, the TaskManager starts empty and both are created.
+     *
+     * @param snapshotPath The path of the snapshot file.
+     * @param journalPath The path of the journal file.
+     * @param options When the journal is written to disk.
+     * @param maxPersons The maximum number of persons when starting empty, otherwise the snapshot's is used.
+     * @throw std::runtime_error If a file can't be read or written, or the snapshot is corrupt, or the journal isn't a
+     *        journal or continues a different snapshot.
+     */
+    JournaledTaskManager(const string &snapshotPath, const string &journalPath,
+                         JournalOptions options = JournalOptions(),
+                         std::size_t maxPersons = TaskManager::UNLIMITED_PERSONS);
+
+    /**
+     * @brief Deleted copy constructor to prevent copying of JournaledTaskManager objects.
+     */
+    JournaledTaskManager(const JournaledTaskManager &other) = delete;
+
+    /**
+     * @brief Deleted copy assignment operator to prevent assignment of JournaledTaskManager objects.
+     */
+    JournaledTaskManager &operator=(const JournaledTaskManager &other) = delete;
+
+    /**
+     * @brief Commits the changes that weren't committed yet and closes the journal.
+     */
+    ~JournaledTaskManager();
+
+    /**
+     * @brief The current state, for reading and printing. Changes must go through the JournaledTaskManager.
+     */
+    const TaskManager &manager() const;
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::registerPerson.
+     */
+    PersonId registerPerson(const string &personName);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::assignTask.
+     */
+    void assignTask(const string &personName, const Task &task);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::assignTask.
+     */
+    void assignTask(PersonId personId, const Task &task);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::assignTasks, as a single record.
+     */
+    void assignTasks(const string &personName, const std::vector<Task> &tasks);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::assignTasks, as a single record.
+     */
+    void assignTasks(const std::vector<std::pair<string, Task>> &tasks);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::completeTask.
+     */
+    void completeTask(const string &personName);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::completeTask.
+     */
+    void completeTask(PersonId personId);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::completeTaskById.
+     */
+    void completeTaskById(TaskId id);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::cancelTask.
+     */
+    bool cancelTask(TaskId id);
+
+    /**
+     * @brief Journals and makes the same change as TaskManager::bumpPriorityByType.
+     */
+    void bumpPriorityByType(TaskType type, int priority);
+
+    /**
+     * @brief Writes and syncs every change that wasn't committed yet.
+     *
+     * If the write fails, whatever part of the group reached the file is cut off again and the group stays pending,
+     * so the next commit writes it whole. If it can't be cut off, every later commit throws - opening the files
+     * again drops the partly written group and recovers everything committed before it.
+     *
+     * @throw std::runtime_error If the journal can't be written.
+     */
+    void commit();
+
+    /**
+     * @brief Saves the whole state as a new snapshot and starts an empty journal on top of it.
+     *
+     * @throw std::runtime_error If a file can't be written. If the snapshot was saved but its journal couldn't be
+     *        started, nothing is committed to the old journal anymore - the next commit starts the new one first.
+     */
+    void compact();
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mtm {
+
+    /**
+     * @brief Bounded lock-free queue for many producer threads and a single consumer thread.
+     *
+     * Every slot of the ring has a sequence number that tells producers and the consumer whose turn it is to use
+     * it, so a producer only needs one compare-and-swap to claim a slot and nobody ever waits on a lock. A push
+     * into a full ring fails instead of waiting, and the caller decides whether to drop or retry.
+     *
+     * Values are moved into and out of the ring, so T must have a move constructor that doesn't throw - a slot
+     * that was claimed is always filled.
+     */
+    template <typename T>
+    class MpscRing {
+        static_assert(std::is_nothrow_move_constructible<T>::value,
+                      "values are moved into slots that were already claimed and need a move that doesn't throw");
+
+        static const std::size_t CACHE_LINE_SIZE = 64;
+
+        struct Slot {
+            std::atomic<std::size_t> m_sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+
+            T* value() {
+                return std::launder(reinterpret_cast<T*>(&m_storage));
+            }
+        };
+
+        Slot* m_slots;
+        std::size_t m_mask;
+        // producers and the consumer each get their own cache line
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_pushPosition;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_popPosition;
+
+    public:
+
+        // constructors
+
+        /**
+         * @param capacity The number of values the ring can hold, rounded up to a power of 2.
+         */
+        explicit MpscRing(std::size_t capacity);
+
+        MpscRing(const MpscRing& other) = delete;
+
+        MpscRing& operator=(const MpscRing& other) = delete;
+
+        ~MpscRing();
+
+        // methods
+
+        /**
+         * @brief Pushes a value, from any thread. Returns false and leaves the value alone if the ring is full.
+         */
+        bool tryPush(T&& value) noexcept;
+
+        /**
+         * @brief Pops the oldest value, from the consumer thread only. Returns false if the ring is empty.
+         */
+        bool tryPop(T& value);
+
+        /**
+         * @brief The number of values waiting in the ring. Only a snapshot while other threads are pushing.
+         */
+        std::size_t size() const noexcept;
+
+        std::size_t capacity() const noexcept;
+    };
+
+    // --------------------------------- MpscRing --------------------------------- //
+
+    template <typename T>
+    MpscRing<T>::MpscRing(std::size_t capacity) : m_slots(nullptr), m_mask(0), m_pushPosition(0), m_popPosition(0) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_slots = new Slot[size];
+        m_mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) { // slot i is free for the push at position i
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename T>
+    MpscRing<T>::~MpscRing() {
+        const std::size_t end = m_pushPosition.load(std::memory_order_relaxed);
+        for (std::size_t position = m_popPosition.load(std::memory_order_relaxed); position != end; ++position) {
+            m_slots[position & m_mask].value()->~T();
+        }
+        delete[] m_slots;
+    }
+
+    // methods
+
+    template <typename T>
+    bool MpscRing<T>::tryPush(T&& value) noexcept {
+        std::size_t position = m_pushPosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[position & m_mask];
+            const std::size_t sequence = slot->m_sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) { // the slot is free, try to claim it
+                if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (lag < 0) { // the slot still holds a value from the previous lap - the ring is full
+                return false;
+            }
+            else { // another producer claimed it first
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+        new (&slot->m_storage) T(std::move(value));
+        slot->m_sequence.store(position + 1, std::memory_order_release); // hand the slot to the consumer
+        return true;
+    }
+
+    template <typename T>
+    bool MpscRing<T>::tryPop(T& value) {
+        const std::size_t position = m_popPosition.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[position & m_mask];
+        if (slot.m_sequence.load(std::memory_order_acquire) != position + 1) { // not filled yet
+            return false;
+        }
+        value = std::move(*slot.value());
+        slot.value()->~T();
+        slot.m_sequence.store(position + m_mask + 1, std::memory_order_release); // free for the next lap
+        m_popPosition.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    template <typename T>
+    std::size_t MpscRing<T>::size() const noexcept {
+        const std::size_t popPosition = m_popPosition.load(std::memory_order_relaxed);
+        const std::size_t pushPosition = m_pushPosition.load(std::memory_order_relaxed);
+        return pushPosition > popPosition ? pushPosition - popPosition : 0;
+    }
+
+    template <typename T>
+    std::size_t MpscRing<T>::capacity() const noexcept {
+        return m_mask + 1;
+    }
+}
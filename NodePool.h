@@ -0,0 +1,305 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace mtm {
+
+    /**
+     * @brief The memory behind a NodePool and all of its copies, with one free list for every object size.
+     *
+     * Memory is requested from the heap in blocks that hold many objects of one size at once, and freed objects
+     * are kept on the free list of their size and handed out again before a new block is requested. Blocks are
+     * only returned to the heap when the memory is destroyed, after the last pool using it.
+     */
+    class NodePoolMemory {
+    public:
+        struct SizeClass {
+            std::size_t m_slotSize;
+            void* m_freeList;         // every free slot starts with a pointer to the next one
+            unsigned char* m_cursor;  // next never-used slot in the current block
+            unsigned char* m_blockEnd;
+            std::size_t m_nextBlockSize;
+            SizeClass* m_next;
+        };
+
+    private:
+        static const std::size_t FIRST_BLOCK_SIZE = 8;
+        static const std::size_t MAX_BLOCK_SIZE = 4096;
+        static const std::size_t BLOCK_HEADER = alignof(std::max_align_t); // keeps the slots aligned
+
+        SizeClass m_first; // most pools only ever hand out one size, so it needs no allocation of its own
+        void* m_blocks;    // every block starts with a pointer to the previous block
+
+        static void initialize(SizeClass& sizeClass, std::size_t slotSize) noexcept;
+
+    public:
+        NodePoolMemory() noexcept;
+
+        NodePoolMemory(const NodePoolMemory& other) = delete;
+
+        NodePoolMemory& operator=(const NodePoolMemory& other) = delete;
+
+        ~NodePoolMemory();
+
+        /**
+         * @brief The free list of a size, or null if nothing of this size was allocated yet.
+         */
+        SizeClass* find(std::size_t slotSize) noexcept;
+
+        /**
+         * @brief The free list of a size, added if nothing of this size was allocated yet.
+         */
+        SizeClass& get(std::size_t slotSize);
+
+        /**
+         * @brief Adds a new block of slots to a size, for when its free list and its current block are used up.
+         */
+        void grow(SizeClass& sizeClass);
+    };
+
+    /**
+     * @brief Slab allocator for fixed-size objects, with the minimal standard allocator interface.
+     *
+     * Single objects come from a NodePoolMemory, larger requests go straight to the heap. Copies of a pool, also
+     * rebound ones, share its memory - they compare equal and can free each other's objects - so, like the list
+     * that owns them, a pool and its copies must only be used from one thread at a time. A list that is copied
+     * still starts its own memory, see select_on_container_copy_construction.
+     *
+     * The memory is only created on the first allocation, so an empty list costs no heap memory, or when the
+     * pool is first copied, so the copies have something to share. Until then a pool only equals itself.
+     */
+    template <typename T>
+    class NodePool {
+        template <typename U>
+        friend class NodePool;
+
+        static_assert(alignof(T) <= alignof(std::max_align_t), "NodePool doesn't support over-aligned types");
+
+        // big enough for a free list link, and a multiple of the alignment so the slots of a block stay aligned
+        static const std::size_t SLOT_ALIGNMENT = alignof(T) > alignof(void*) ? alignof(T) : alignof(void*);
+        static const std::size_t SLOT_SIZE =
+            ((sizeof(T) > sizeof(void*) ? sizeof(T) : sizeof(void*)) + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT *
+            SLOT_ALIGNMENT;
+
+        // null until the first allocation or copy, and again after being moved from
+        mutable std::shared_ptr<NodePoolMemory> m_memory;
+        NodePoolMemory::SizeClass* m_class; // the free list of T's size, found on first use
+
+        const std::shared_ptr<NodePoolMemory>& sharedMemory() const;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
+        template <typename U>
+        struct rebind {
+            using other = NodePool<U>;
+        };
+
+        // constructors
+
+        NodePool() noexcept;
+
+        NodePool(const NodePool& other);
+
+        template <typename U>
+        NodePool(const NodePool<U>& other);
+
+        NodePool(NodePool&& other) noexcept;
+
+        NodePool& operator=(const NodePool& other);
+
+        NodePool& operator=(NodePool&& other) noexcept;
+
+        // methods
+
+        T* allocate(std::size_t count);
+
+        void deallocate(T* pointer, std::size_t count) noexcept;
+
+        /**
+         * @brief A copied list gets a new pool, so lists never share memory with the list they were copied from.
+         */
+        NodePool select_on_container_copy_construction() const;
+
+        template <typename U>
+        bool operator==(const NodePool<U>& other) const noexcept;
+
+        template <typename U>
+        bool operator!=(const NodePool<U>& other) const noexcept;
+    };
+
+    // ----------------------------- NodePoolMemory ----------------------------- //
+
+    inline NodePoolMemory::NodePoolMemory() noexcept : m_first(), m_blocks(nullptr) {
+        initialize(m_first, 0);
+    }
+
+    inline NodePoolMemory::~NodePoolMemory() {
+        while (m_blocks != nullptr) {
+            void* previous = *static_cast<void**>(m_blocks);
+            ::operator delete(m_blocks);
+            m_blocks = previous;
+        }
+        SizeClass* sizeClass = m_first.m_next;
+        while (sizeClass != nullptr) {
+            SizeClass* next = sizeClass->m_next;
+            delete sizeClass;
+            sizeClass = next;
+        }
+    }
+
+    inline NodePoolMemory::SizeClass* NodePoolMemory::find(std::size_t slotSize) noexcept {
+        for (SizeClass* sizeClass = &m_first; sizeClass != nullptr; sizeClass = sizeClass->m_next) {
+            if (sizeClass->m_slotSize == slotSize) {
+                return sizeClass;
+            }
+        }
+        return nullptr;
+    }
+
+    inline NodePoolMemory::SizeClass& NodePoolMemory::get(std::size_t slotSize) {
+        SizeClass* sizeClass = find(slotSize);
+        if (sizeClass != nullptr) {
+            return *sizeClass;
+        }
+        if (m_first.m_slotSize == 0) {
+            m_first.m_slotSize = slotSize;
+            return m_first;
+        }
+        sizeClass = new SizeClass();
+        initialize(*sizeClass, slotSize);
+        sizeClass->m_next = m_first.m_next;
+        m_first.m_next = sizeClass;
+        return *sizeClass;
+    }
+
+    inline void NodePoolMemory::grow(SizeClass& sizeClass) {
+        unsigned char* block =
+            static_cast<unsigned char*>(::operator new(BLOCK_HEADER + sizeClass.m_nextBlockSize * sizeClass.m_slotSize));
+        *reinterpret_cast<void**>(block) = m_blocks;
+        m_blocks = block;
+        sizeClass.m_cursor = block + BLOCK_HEADER;
+        sizeClass.m_blockEnd = sizeClass.m_cursor + sizeClass.m_nextBlockSize * sizeClass.m_slotSize;
+        if (sizeClass.m_nextBlockSize < MAX_BLOCK_SIZE) { // small lists stay small, big lists allocate rarely
+            sizeClass.m_nextBlockSize *= 2;
+        }
+    }
+
+    inline void NodePoolMemory::initialize(SizeClass& sizeClass, std::size_t slotSize) noexcept {
+        sizeClass.m_slotSize = slotSize;
+        sizeClass.m_freeList = nullptr;
+        sizeClass.m_cursor = sizeClass.m_blockEnd = nullptr;
+        sizeClass.m_nextBlockSize = FIRST_BLOCK_SIZE;
+        sizeClass.m_next = nullptr;
+    }
+
+    // -------------------------------- NodePool -------------------------------- //
+
+    template <typename T>
+    NodePool<T>::NodePool() noexcept : m_memory(), m_class(nullptr) {}
+
+    template <typename T>
+    NodePool<T>::NodePool(const NodePool& other) : m_memory(other.sharedMemory()), m_class(other.m_class) {}
+
+    template <typename T>
+    template <typename U>
+    NodePool<T>::NodePool(const NodePool<U>& other) : m_memory(other.sharedMemory()), m_class(nullptr) {}
+
+    template <typename T>
+    NodePool<T>::NodePool(NodePool&& other) noexcept : m_memory(std::move(other.m_memory)), m_class(other.m_class) {
+        other.m_class = nullptr;
+    }
+
+    template <typename T>
+    NodePool<T>& NodePool<T>::operator=(const NodePool& other) {
+        m_memory = other.sharedMemory();
+        m_class = other.m_class;
+        return *this;
+    }
+
+    template <typename T>
+    NodePool<T>& NodePool<T>::operator=(NodePool&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        m_memory = std::move(other.m_memory);
+        m_class = other.m_class;
+        other.m_class = nullptr;
+        return *this;
+    }
+
+    // methods
+
+    template <typename T>
+    const std::shared_ptr<NodePoolMemory>& NodePool<T>::sharedMemory() const {
+        if (m_memory == nullptr) {
+            m_memory = std::make_shared<NodePoolMemory>();
+        }
+        return m_memory;
+    }
+
+    template <typename T>
+    T* NodePool<T>::allocate(std::size_t count) {
+        if (count != 1) { // only single objects are pooled
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+        if (m_class == nullptr) {
+            m_class = &sharedMemory()->get(SLOT_SIZE);
+        }
+        NodePoolMemory::SizeClass& sizeClass = *m_class;
+        if (sizeClass.m_freeList != nullptr) { // reuse a freed slot first
+            void* slot = sizeClass.m_freeList;
+            sizeClass.m_freeList = *static_cast<void**>(slot);
+            return static_cast<T*>(slot);
+        }
+        if (sizeClass.m_cursor == sizeClass.m_blockEnd) {
+            m_memory->grow(sizeClass);
+        }
+        void* slot = sizeClass.m_cursor;
+        sizeClass.m_cursor += SLOT_SIZE;
+        return static_cast<T*>(slot);
+    }
+
+    template <typename T>
+    void NodePool<T>::deallocate(T* pointer, std::size_t count) noexcept {
+        if (pointer == nullptr) {
+            return;
+        }
+        if (count != 1) {
+            ::operator delete(pointer);
+            return;
+        }
+        if (m_class == nullptr) { // the object came from an equal pool, so its size is already there
+            m_class = m_memory->find(SLOT_SIZE);
+        }
+        *reinterpret_cast<void**>(pointer) = m_class->m_freeList;
+        m_class->m_freeList = pointer;
+    }
+
+    template <typename T>
+    NodePool<T> NodePool<T>::select_on_container_copy_construction() const {
+        return NodePool();
+    }
+
+    template <typename T>
+    template <typename U>
+    bool NodePool<T>::operator==(const NodePool<U>& other) const noexcept {
+        if (m_memory == nullptr) { // nothing was allocated or shared yet
+            return static_cast<const void*>(this) == static_cast<const void*>(&other);
+        }
+        return m_memory == other.m_memory; // memory can only be given back to the pool it came from
+    }
+
+    template <typename T>
+    template <typename U>
+    bool NodePool<T>::operator!=(const NodePool<U>& other) const noexcept {
+        return !(*this == other);
+    }
+}
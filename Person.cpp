@@ -1,34 +1,70 @@
 
 #include "Person.h"
-using std::endl;
 
 // Constructor
 Person::Person(const string &name) : m_name(name) {}
 
 // Getters and setters
-string Person::getName() const {
+const string& Person::getName() const {
     return m_name;
 }
 
-const SortedList<Task>& Person::getTasks() const {
+const Person::TaskQueue& Person::getTasks() const {
     return m_tasks;
 }
 
-void Person::setTasks(const SortedList<Task>& tasks) {
+void Person::setTasks(const TaskQueue& tasks) {
     m_tasks = tasks;
 }
 
+void Person::setTasks(TaskQueue&& tasks) {
+    m_tasks = std::move(tasks);
+}
+
+void Person::setTasks(const SortedList<Task>& tasks) {
+    m_tasks = TaskQueue(tasks.begin(), tasks.end());
+}
+
 // Other methods
-void Person::assignTask(const Task& task) {
-    m_tasks.insert(task);
+Person::TaskQueue::ConstIterator Person::assignTask(const Task& task) {
+    return m_tasks.emplace(task);
+}
+
+Person::TaskQueue::ConstIterator Person::assignTask(Task&& task) {
+    return m_tasks.emplace(std::move(task));
+}
+
+void Person::assignTasks(const std::vector<Task>& tasks) {
+    m_tasks.insertRange(tasks.begin(), tasks.end());
+}
+
+void Person::assignTasks(std::vector<Task>&& tasks) {
+    m_tasks.insertRange(std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+    tasks.clear();
+}
+
+void Person::replaceTask(const Task& task, Task newTask) {
+    const auto toReplace = m_tasks.find(task);
+    if (!(toReplace != m_tasks.end())) {
+        throw std::runtime_error("Task is not assigned to this person.");
+    }
+    m_tasks.replace(toReplace, std::move(newTask));
+}
+
+void Person::replaceTask(const TaskQueue::ConstIterator& position, Task newTask) {
+    m_tasks.replace(position, std::move(newTask));
+}
+
+void Person::removeTask(const TaskQueue::ConstIterator& position) {
+    m_tasks.remove(position);
 }
 
 
-int Person::completeTask() {
+TaskId Person::completeTask() {
     if (m_tasks.length() == 0) {
         throw std::runtime_error("No tasks assigned to this person.");
     }
-    int taskId = (*m_tasks.begin()).getId();
+    TaskId taskId = (*m_tasks.begin()).getId();
     m_tasks.remove(m_tasks.begin());
     return taskId;
 }
@@ -42,10 +78,10 @@ const Task& Person::getHighestPriorityTask() const {
 
 // Overloaded operators
 ostream& operator<<(ostream& os, const Person& person) {
-    os << "Person: " << person.m_name << endl;
+    os << "Person: " << person.m_name << '\n';
     // Assuming the SortedList has an appropriate method to list tasks
     for (const Task& t: person.m_tasks) {
-        os << t << endl;
+        os << t << '\n';
     }
     return os;
 }
@@ -3,8 +3,10 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include "Task.h"
 #include "SortedList.h"
+#include "BucketedSortedList.h"
 
 using mtm::SortedList;
 using std::ostream;
@@ -14,9 +16,16 @@ using std::string;
  * @brief Class representing a person who can have tasks assigned.
  */
 class Person {
+public:
+    /**
+     * @brief The list a person keeps their tasks in - one bucket per priority, so the highest priority task is
+     * always first and new tasks are added in O(1). Works like SortedList<Task> and keeps the same order.
+     */
+    using TaskQueue = SortedList<Task, std::greater<Task>, mtm::PriorityBuckets<TaskPriorityKey, Task::MAX_PRIORITY>>;
+
 private:
     string m_name;
-    SortedList<Task> m_tasks;
+    TaskQueue m_tasks;
 
 public:
     /**
@@ -29,37 +38,109 @@ public:
     /**
      * @brief Gets the name of the person.
      *
-     * @return string The name of the person.
+     * @return const string& The name of the person.
      */
-    string getName() const;
+    const string& getName() const;
 
     /**
      * @brief Gets the list of tasks assigned to the person.
      *
-     * @return const SortedList<Task>& The list of tasks assigned to the person.
+     * @return const TaskQueue& The list of tasks assigned to the person.
      */
-    const SortedList<Task>& getTasks() const;
+    const TaskQueue& getTasks() const;
 
     /**
      * @brief Sets the list of tasks for the person.
      *
      * @param tasks The list of tasks to be set.
      */
+    void setTasks(const TaskQueue& tasks);
+
+    /**
+     * @brief Sets the list of tasks for the person, taking over the given list without copying it.
+     *
+     * @param tasks The list of tasks to be set.
+     */
+    void setTasks(TaskQueue&& tasks);
+
+    /**
+     * @brief Sets the list of tasks for the person from a SortedList<Task>.
+     *
+     * @param tasks The list of tasks to be set.
+     */
     void setTasks(const SortedList<Task>& tasks);
 
     /**
      * @brief Assigns a new task to the person.
      *
      * @param task The task to be assigned.
+     * @return TaskQueue::ConstIterator The task inside the person's list, valid until it is removed.
+     */
+    TaskQueue::ConstIterator assignTask(const Task& task);
+
+    /**
+     * @brief Assigns a new task to the person, moving it into the list.
+     *
+     * @param task The task to be assigned.
+     * @return TaskQueue::ConstIterator The task inside the person's list, valid until it is removed.
+     */
+    TaskQueue::ConstIterator assignTask(Task&& task);
+
+    /**
+     * @brief Assigns many tasks to the person at once, merging them into the list in one pass.
+     *
+     * @param tasks The tasks to be assigned.
      */
-    void assignTask(const Task& task);
+    void assignTasks(const std::vector<Task>& tasks);
+
+    /**
+     * @brief Assigns many tasks to the person at once, moving them into the list.
+     *
+     * @param tasks The tasks to be assigned.
+     */
+    void assignTasks(std::vector<Task>&& tasks);
+
+    /**
+     * @brief Replaces every task that satisfies a condition with the result of an operation on it.
+     *
+     * The tasks are updated inside the person's list, only the changed tasks are moved to their new places.
+     *
+     * @param predicate Returns true for the tasks that should be updated.
+     * @param function Returns the updated version of a task.
+     */
+    template <typename Predicate, typename Function>
+    void updateTasks(Predicate predicate, Function function);
+
+    /**
+     * @brief Replaces one of the person's tasks with an updated version of it.
+     *
+     * @param task The task to be replaced, found by its priority and ID.
+     * @param newTask The updated task.
+     * @throw std::runtime_error If the person doesn't have the task.
+     */
+    void replaceTask(const Task& task, Task newTask);
+
+    /**
+     * @brief Replaces the task at a position in the person's list with an updated version of it, without searching.
+     *
+     * @param position The task to be replaced, as returned by assignTask. It stays valid.
+     * @param newTask The updated task.
+     */
+    void replaceTask(const TaskQueue::ConstIterator& position, Task newTask);
+
+    /**
+     * @brief Removes the task at a position in the person's list, without searching.
+     *
+     * @param position The task to be removed, as returned by assignTask.
+     */
+    void removeTask(const TaskQueue::ConstIterator& position);
 
     /**
      * @brief Completes the highest priority task from the list of tasks.
      *
-     * @return int The ID of the completed task.
+     * @return TaskId The ID of the completed task.
      */
-    int completeTask();
+    TaskId completeTask();
 
     /**
      * @brief Gets the highest priority task assigned to the person.
@@ -77,3 +158,8 @@ public:
      */
     friend ostream &operator<<(ostream &os, const Person &person);
 };
+
+template <typename Predicate, typename Function>
+void Person::updateTasks(Predicate predicate, Function function) {
+    m_tasks.applyInPlace(predicate, function);
+}
@@ -1,33 +1,100 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <utility>
+#include <vector>
+#include "NodePool.h"
 
 namespace mtm {
 
-    template <typename T>
+    template <typename Container, typename Predicate>
+    class FilteredView;
+
+    template <typename Container, typename Function>
+    class TransformedView;
+
+    /**
+     * ByKey - a Compare for SortedList that orders elements by a key computed from each of them.
+     * keys are compared with KeyOrder, so by default the element with the largest key comes first.
+     */
+    template <typename KeyFunction, typename KeyOrder = std::greater<>>
+    struct ByKey {
+        KeyFunction m_key;
+        KeyOrder m_order;
+
+        template <typename T>
+        bool operator()(const T& lhs, const T& rhs) const {
+            return m_order(m_key(lhs), m_key(rhs));
+        }
+    };
+
+    template <typename T, typename Compare = std::greater<T>, typename Allocator = NodePool<T>>
     class SortedList {
         class Node;
 
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+        using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+        // skip list index - every level holds about a quarter of the nodes of the level below it
+        static const unsigned int MAX_INDEX_LEVEL = 16;
+        static const unsigned int INITIAL_RANDOM_STATE = 2463534242u;
+
+        Compare m_compare; // m_compare(a, b) is true if a comes before b in the list
+        NodeAllocator m_allocator;
         Node* m_head;
         Node* m_tail;
         unsigned int m_size;
 
+        bool m_indexed;
+        unsigned int m_indexLevel; // number of index levels currently in use
+        Node* m_indexHead[MAX_INDEX_LEVEL];
+        unsigned int m_randomState;
+
+        bool comesBefore(const T& lhs, const T& rhs) const;
+
+        template <typename... Args>
+        Node* createNode(Node* next, Node* prev, Args&&... args);
+        void destroyNode(Node* node) noexcept;
+        void createTower(Node* node, unsigned int level);
+        void destroyTower(Node* node) noexcept;
         void clear(Node* headToDelete);
         void copyList(Node *&newHead, Node *&newTail, const SortedList& other);
 
+        unsigned int randomLevel();
+        void linkNode(Node* newNode);
+        void linkPlain(Node* newNode);
+        void mergeChain(Node* otherHead, Node* otherTail);
+        void linkIndexed(Node* newNode);
+        void unlinkFromIndex(Node* node) noexcept;
+        void dropIndex() noexcept;
+        void rebuildIndex();
+
     public:
 
         // constructors
 
         SortedList();
 
+        explicit SortedList(const Compare& compare);
+
         SortedList(const SortedList& other);
 
+        SortedList(SortedList&& other) noexcept;
+
+        template <typename InputIterator>
+        SortedList(InputIterator first, InputIterator last, const Compare& compare = Compare());
+
         ~SortedList();
 
         SortedList& operator=(const SortedList& other);
 
+        SortedList& operator=(SortedList&& other) noexcept;
+
         // iterator
 
         class ConstIterator;
@@ -40,16 +107,47 @@ namespace mtm {
 
         SortedList &insert(const T &newData);
 
+        SortedList &insert(T &&newData);
+
+        template <typename... Args>
+        ConstIterator emplace(Args&&... args);
+
+        template <typename InputIterator>
+        SortedList &insertRange(InputIterator first, InputIterator last);
+
         SortedList &remove(const ConstIterator &givenIt);
 
+        ConstIterator replace(const ConstIterator &givenIt, T newData);
+
         int length() const;
 
+        const Compare& getCompare() const;
+
+        ConstIterator find(const T& data) const;
+
+        SortedList &enableIndex();
+
+        SortedList &disableIndex();
+
+        bool isIndexed() const;
+
         template <typename Function>
         SortedList filter(Function filterFunction) const;
 
         template <typename Function>
         SortedList apply(Function applyFunction) const;
 
+        static SortedList merge(const std::vector<const SortedList*>& lists);
+
+        template <typename Predicate, typename Function>
+        SortedList &applyInPlace(Predicate predicate, Function applyFunction);
+
+        template <typename Predicate>
+        FilteredView<SortedList, Predicate> filtered(Predicate predicate) const;
+
+        template <typename Function>
+        TransformedView<SortedList, Function> transformed(Function function) const;
+
 
         /**
          *
@@ -57,9 +155,10 @@ namespace mtm {
          * if needed, use =defualt / =delete
          *
          * constructors and destructor:
-         * 1. SortedList() - creates an empty list.
-         * 2. copy constructor
-         * 3. operator= - assignment operator
+         * 1. SortedList() - creates an empty list. SortedList(first, last) - creates a list from a range.
+         *    both can take the Compare object to use, compare(a, b) is true if a should come before b
+         * 2. copy constructor and move constructor
+         * 3. operator= - copy and move assignment operators
          * 4. ~SortedList() - destructor
          *
          * iterator:
@@ -68,31 +167,53 @@ namespace mtm {
          * 7. end method
          *
          * functions:
-         * 8. insert - inserts a new element to the list
+         * 8. insert - inserts a new element to the list, emplace - constructs it in place inside the list and
+         *    returns an iterator to it, insertRange - inserts a whole range, sorting it once and merging it in
          * 9. remove - removes an element from the list
          * 10. length - returns the number of elements in the list
          * 11. filter - returns a new list with elements that satisfy a given condition
          * 12. apply - returns a new list with elements that were modified by an operation
+         *     (if the operation keeps the order, the new list is built in one pass without sorting)
+         * 13. find - returns an iterator to the first element equal to the given one, or end()
+         * 14. enableIndex / disableIndex / isIndexed - control the skip list index. an indexed list finds
+         *     positions for insert and find in O(log n) instead of walking the whole list
+         * 15. merge - returns a new list with the elements of many lists, built in O(N log k) for k lists.
+         *     equal elements are taken from the earlier list first, as if inserted list by list
+         * 16. applyInPlace - replaces the elements that satisfy a condition with the result of an operation on
+         *     them, inside the list. only the changed nodes are moved, the rest of the list stays where it is
+         * 17. filtered / transformed - return lazy views of the list, nothing is copied or allocated until the
+         *     view is turned into a list with toList(). the list must outlive its views
+         * 18. replace - replaces one element and moves it to its new place. the node is kept, so iterators and
+         *     pointers to the element stay valid and nothing is allocated
+         * 19. getCompare - returns the Compare object that orders the list
          */
 
     };
 
-    template<typename T>
-    class SortedList<T>::Node {
+    template <typename T, typename Compare, typename Allocator>
+    class SortedList<T, Compare, Allocator>::Node {
         friend SortedList;
 
+        struct Link {
+            Node* m_next;
+            Node* m_prev;
+        };
+
         T m_data;
         Node* m_next;
         Node* m_prev;
+        Link* m_tower; // links on index levels 1..m_level from the list's allocator, nullptr for base level only
+        unsigned int m_level;
 
         // constructor
-        explicit Node(const T& data, Node* next = nullptr, Node* prev = nullptr);
+        template <typename... Args>
+        explicit Node(Node* next, Node* prev, Args&&... args);
         ~Node() = default;
 
     };
 
-    template <class T>
-    class SortedList<T>::ConstIterator {
+    template <typename T, typename Compare, typename Allocator>
+    class SortedList<T, Compare, Allocator>::ConstIterator {
         friend SortedList;
 
         Node* m_currentNode;
@@ -130,23 +251,61 @@ namespace mtm {
 
     // ------------------------------- SortedList ------------------------------- //
 
-    template <typename T>
-    SortedList<T>::SortedList() : m_head(nullptr), m_tail(nullptr), m_size(0) {}
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>::SortedList() : SortedList(Compare()) {}
 
-    template<typename T>
-    SortedList<T>::SortedList(const SortedList &other) : m_head(nullptr), m_tail(nullptr), m_size(other.m_size) {
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>::SortedList(const Compare& compare)
+        : m_compare(compare), m_allocator(), m_head(nullptr), m_tail(nullptr), m_size(0),
+          m_indexed(false), m_indexLevel(0), m_indexHead(), m_randomState(INITIAL_RANDOM_STATE) {}
+
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>::SortedList(const SortedList &other)
+        : m_compare(other.m_compare),
+          m_allocator(NodeAllocatorTraits::select_on_container_copy_construction(other.m_allocator)),
+          m_head(nullptr), m_tail(nullptr), m_size(other.m_size),
+          m_indexed(other.m_indexed), m_indexLevel(0), m_indexHead(), m_randomState(other.m_randomState) {
         copyList(m_head, m_tail, other);
+        if (m_indexed) {
+            try {
+                rebuildIndex();
+            }
+            catch (...) {
+                clear(m_head);
+                throw;
+            }
+        }
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>::SortedList(SortedList &&other) noexcept
+        : m_compare(other.m_compare), m_allocator(std::move(other.m_allocator)), m_head(other.m_head), m_tail(other.m_tail),
+          m_size(other.m_size), m_indexed(other.m_indexed), m_indexLevel(other.m_indexLevel), m_indexHead(),
+          m_randomState(other.m_randomState) {
+        // the nodes (and the pool they live in) now belong to us, leave other empty
+        std::copy(other.m_indexHead, other.m_indexHead + MAX_INDEX_LEVEL, m_indexHead);
+        other.m_head = other.m_tail = nullptr;
+        other.m_size = 0;
+        other.m_indexLevel = 0;
+        std::fill(other.m_indexHead, other.m_indexHead + MAX_INDEX_LEVEL, nullptr);
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename InputIterator>
+    SortedList<T, Compare, Allocator>::SortedList(InputIterator first, InputIterator last, const Compare& compare)
+        : SortedList(compare) {
+        insertRange(first, last);
     }
 
-    template<typename T>
-    SortedList<T>::~SortedList() {
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>::~SortedList() {
         clear(m_head);
         m_head = nullptr;
         m_tail = nullptr;
     }
 
-    template <typename T>
-    SortedList<T>& SortedList<T>::operator=(const SortedList& other) {
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>& SortedList<T, Compare, Allocator>::operator=(const SortedList& other) {
         if (this == &other) { // if they are the same
             return *this;
         }
@@ -158,55 +317,142 @@ namespace mtm {
         copyList(newHead, newTail, other); // copy the list into the new parameters
 
         clear(m_head); // delete the old list
+        m_indexLevel = 0;
+        std::fill(m_indexHead, m_indexHead + MAX_INDEX_LEVEL, nullptr);
 
         // make this the new list
+        m_compare = other.m_compare;
         m_head = newHead;
         m_tail = newTail;
         m_size = newSize;
+        m_indexed = other.m_indexed;
+        if (m_indexed) {
+            rebuildIndex();
+        }
+
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>& SortedList<T, Compare, Allocator>::operator=(SortedList&& other) noexcept {
+        static_assert(NodeAllocatorTraits::propagate_on_container_move_assignment::value ||
+                      NodeAllocatorTraits::is_always_equal::value,
+                      "moving a SortedList requires an allocator that can be moved along with its nodes");
+        if (this == &other) {
+            return *this;
+        }
+        clear(m_head); // our nodes go back to our allocator before it is replaced
+
+        m_compare = other.m_compare;
+        m_allocator = std::move(other.m_allocator);
+        m_head = other.m_head;
+        m_tail = other.m_tail;
+        m_size = other.m_size;
+        m_indexed = other.m_indexed;
+        m_indexLevel = other.m_indexLevel;
+        std::copy(other.m_indexHead, other.m_indexHead + MAX_INDEX_LEVEL, m_indexHead);
+
+        other.m_head = other.m_tail = nullptr;
+        other.m_size = 0;
+        other.m_indexLevel = 0;
+        std::fill(other.m_indexHead, other.m_indexHead + MAX_INDEX_LEVEL, nullptr);
 
         return *this;
     }
 
     // methods
 
-    template<typename T>
-    SortedList<T> &SortedList<T>::insert(const T &newData) {
-        if (m_head == nullptr) { // the list is empty
-            m_head = m_tail = new Node(newData, nullptr, nullptr);
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator> &SortedList<T, Compare, Allocator>::insert(const T &newData) {
+        emplace(newData);
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator> &SortedList<T, Compare, Allocator>::insert(T &&newData) {
+        emplace(std::move(newData));
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename... Args>
+    typename SortedList<T, Compare, Allocator>::ConstIterator SortedList<T, Compare, Allocator>::emplace(Args&&... args) {
+        // build the node first, its data is what decides where it goes
+        Node* newNode = createNode(nullptr, nullptr, std::forward<Args>(args)...);
+        try {
+            linkNode(newNode);
         }
-        else if (newData > m_head->m_data) { // insert into the first spot
-            Node* newNode = new Node(newData, m_head, nullptr);
-            m_head->m_prev = newNode;
-            m_head = newNode;
+        catch (...) { // only allocating the index tower can fail, nothing has been linked yet
+            destroyNode(newNode);
+            throw;
         }
-        else if (!(newData > m_tail->m_data)) { // insert into the last spot
-            Node* newNode = new Node(newData, nullptr, m_tail);
-            m_tail->m_next = newNode;
-            m_tail = newNode;
+        m_size++;
+
+        return ConstIterator(newNode);
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename InputIterator>
+    SortedList<T, Compare, Allocator> &SortedList<T, Compare, Allocator>::insertRange(InputIterator first, InputIterator last) {
+        // allocate all the new nodes in one sweep
+        std::vector<Node*> newNodes;
+        try {
+            for (; first != last; ++first) {
+                newNodes.push_back(nullptr); // reserve the slot first, so a new node is never lost
+                newNodes.back() = createNode(nullptr, nullptr, *first);
+            }
         }
-        else { // find where to insert
-            for (ConstIterator It = begin(); It != end(); ++It) {
-                if (!(newData > *It) && newData > It.m_currentNode->m_next->m_data) {
-                    Node* newNode = new Node(newData, It.m_currentNode->m_next, It.m_currentNode);
-                    It.m_currentNode->m_next = newNode;
-                    newNode->m_next->m_prev = newNode;
-                    break;
+        catch (...) {
+            for (Node* node : newNodes) {
+                if (node != nullptr) {
+                    destroyNode(node);
                 }
             }
+            throw;
+        }
+        if (newNodes.empty()) {
+            return *this;
         }
 
-        m_size++;
+        // sort the batch once - stable, so equal elements keep the order they were given in
+        const auto comesFirst = [this](const Node* lhs, const Node* rhs) {
+            return comesBefore(lhs->m_data, rhs->m_data);
+        };
+        try {
+            if (!std::is_sorted(newNodes.begin(), newNodes.end(), comesFirst)) {
+                std::stable_sort(newNodes.begin(), newNodes.end(), comesFirst);
+            }
+        }
+        catch (...) {
+            for (Node* node : newNodes) {
+                destroyNode(node);
+            }
+            throw;
+        }
+
+        // chain the batch and merge it into the list in one pass
+        for (std::size_t i = 1; i < newNodes.size(); ++i) {
+            newNodes[i - 1]->m_next = newNodes[i];
+            newNodes[i]->m_prev = newNodes[i - 1];
+        }
+        m_size += static_cast<unsigned int>(newNodes.size());
+        mergeChain(newNodes.front(), newNodes.back());
+        if (m_indexed) {
+            rebuildIndex();
+        }
 
         return *this;
     }
 
-    template<typename T>
-    SortedList<T> &SortedList<T>::remove(const ConstIterator &givenIt) {
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator> &SortedList<T, Compare, Allocator>::remove(const ConstIterator &givenIt) {
         Node* victim = givenIt.m_currentNode;
         if (victim == nullptr) {
             return *this;
         }
 
+        unlinkFromIndex(victim);
+
         Node* prev = victim->m_prev;
         Node* next = victim->m_next;
         // if prev exists connect it to the next;
@@ -224,79 +470,284 @@ namespace mtm {
             m_tail = prev;
         }
         // delete what you want to remove
-        delete victim;
+        destroyNode(victim);
         // decrease size
         m_size--;
 
         return *this;
     }
 
-    template<typename T>
-    int SortedList<T>::length() const {
+    template <typename T, typename Compare, typename Allocator>
+    typename SortedList<T, Compare, Allocator>::ConstIterator SortedList<T, Compare, Allocator>::replace(const ConstIterator &givenIt, T newData) {
+        Node* node = givenIt.m_currentNode;
+        if (node == nullptr) {
+            return end();
+        }
+        node->m_data = std::move(newData);
+
+        // nothing to do if the node is still between its neighbours
+        const bool afterPrev = node->m_prev == nullptr || !comesBefore(node->m_data, node->m_prev->m_data);
+        const bool beforeNext = node->m_next == nullptr || !comesBefore(node->m_next->m_data, node->m_data);
+        if (afterPrev && beforeNext) {
+            return ConstIterator(node);
+        }
+
+        unlinkFromIndex(node);
+        destroyTower(node);
+        (node->m_prev != nullptr ? node->m_prev->m_next : m_head) = node->m_next;
+        (node->m_next != nullptr ? node->m_next->m_prev : m_tail) = node->m_prev;
+        node->m_next = node->m_prev = nullptr;
+        if (m_indexed) {
+            try {
+                linkIndexed(node);
+            }
+            catch (...) { // no memory for its index tower, the base level is enough to keep it
+                linkPlain(node);
+            }
+        }
+        else {
+            linkPlain(node);
+        }
+
+        return ConstIterator(node);
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    int SortedList<T, Compare, Allocator>::length() const {
         return m_size;
     }
 
-    template<typename T>
-    template<typename Function>
-    SortedList<T> SortedList<T>::filter(Function filterFunction) const {
-        SortedList newList;
-        for (ConstIterator It = begin(); It != end(); ++It) {
-            if (filterFunction(*It)) {
-                newList.insert(*It);
+    template <typename T, typename Compare, typename Allocator>
+    const Compare& SortedList<T, Compare, Allocator>::getCompare() const {
+        return m_compare;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    typename SortedList<T, Compare, Allocator>::ConstIterator SortedList<T, Compare, Allocator>::find(const T &data) const {
+        // find the last node that comes strictly before data, going down the index levels first
+        Node* pred = nullptr;
+        for (unsigned int level = m_indexLevel; level > 0; --level) {
+            Node* next = pred == nullptr ? m_indexHead[level - 1] : pred->m_tower[level - 1].m_next;
+            while (next != nullptr && comesBefore(next->m_data, data)) {
+                pred = next;
+                next = next->m_tower[level - 1].m_next;
             }
         }
+        Node* next = pred == nullptr ? m_head : pred->m_next;
+        while (next != nullptr && comesBefore(next->m_data, data)) {
+            next = next->m_next;
+        }
+        // the next node is the first candidate, it is equal if it doesn't come before data either
+        if (next != nullptr && !comesBefore(data, next->m_data)) {
+            return ConstIterator(next);
+        }
+        return end();
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator> &SortedList<T, Compare, Allocator>::enableIndex() {
+        if (!m_indexed) {
+            rebuildIndex();
+            m_indexed = true;
+        }
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator> &SortedList<T, Compare, Allocator>::disableIndex() {
+        dropIndex();
+        m_indexed = false;
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    bool SortedList<T, Compare, Allocator>::isIndexed() const {
+        return m_indexed;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename Function>
+    SortedList<T, Compare, Allocator> SortedList<T, Compare, Allocator>::filter(Function filterFunction) const {
+        SortedList newList(m_compare);
+        newList.m_indexed = m_indexed; // the result keeps the order and the indexing mode
+        const FilteredView<SortedList, Function> view = filtered(filterFunction);
+        newList.insertRange(view.begin(), view.end()); // already sorted, so this is a single pass
 
         return newList;
     }
 
-    template<typename T>
-    template<typename Function>
-    SortedList<T> SortedList<T>::apply(Function applyFunction) const {
-        SortedList newList;
-        for (ConstIterator It = begin(); It != end(); ++It) {
-            Node* curNode = It.m_currentNode;
-            newList.insert(applyFunction(curNode->m_data));
-        }
+    template <typename T, typename Compare, typename Allocator>
+    template <typename Function>
+    SortedList<T, Compare, Allocator> SortedList<T, Compare, Allocator>::apply(Function applyFunction) const {
+        SortedList newList(m_compare);
+        newList.m_indexed = m_indexed;
+        const TransformedView<SortedList, Function> view = transformed(applyFunction);
+        newList.insertRange(view.begin(), view.end()); // only sorts if the function changed the order
 
         return newList;
     }
 
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator> SortedList<T, Compare, Allocator>::merge(const std::vector<const SortedList*>& lists) {
+        // a heap of the current head of every list, ordered so the element that comes first is on top
+        using Head = std::pair<const Node*, std::size_t>;
+        SortedList merged(lists.empty() || lists.front() == nullptr ? Compare() : lists.front()->m_compare);
+        const auto comesLater = [&merged](const Head& lhs, const Head& rhs) {
+            if (merged.comesBefore(rhs.first->m_data, lhs.first->m_data)) {
+                return true;
+            }
+            if (merged.comesBefore(lhs.first->m_data, rhs.first->m_data)) {
+                return false;
+            }
+            return lhs.second > rhs.second;
+        };
+        std::vector<Head> heads;
+        heads.reserve(lists.size());
+        for (std::size_t i = 0; i < lists.size(); ++i) {
+            if (lists[i] != nullptr && lists[i]->m_head != nullptr) {
+                heads.emplace_back(lists[i]->m_head, i);
+            }
+        }
+        std::make_heap(heads.begin(), heads.end(), comesLater);
+
+        while (!heads.empty()) {
+            std::pop_heap(heads.begin(), heads.end(), comesLater);
+            Head& first = heads.back();
+            // every element goes after the last one, so linking is O(1)
+            Node* newNode = merged.createNode(nullptr, merged.m_tail, first.first->m_data);
+            (merged.m_tail != nullptr ? merged.m_tail->m_next : merged.m_head) = newNode;
+            merged.m_tail = newNode;
+            merged.m_size++;
+
+            if (first.first->m_next != nullptr) {
+                first.first = first.first->m_next;
+                std::push_heap(heads.begin(), heads.end(), comesLater);
+            }
+            else {
+                heads.pop_back();
+            }
+        }
+
+        return merged;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename Predicate, typename Function>
+    SortedList<T, Compare, Allocator> &SortedList<T, Compare, Allocator>::applyInPlace(Predicate predicate, Function applyFunction) {
+        // take the matching nodes out of the list, the others keep their order
+        std::vector<Node*> changed;
+        for (Node* cur = m_head; cur != nullptr; cur = cur->m_next) {
+            if (predicate(cur->m_data)) {
+                changed.push_back(cur);
+            }
+        }
+        if (changed.empty()) {
+            return *this;
+        }
+        for (Node* node : changed) {
+            unlinkFromIndex(node);
+            destroyTower(node);
+            (node->m_prev != nullptr ? node->m_prev->m_next : m_head) = node->m_next;
+            (node->m_next != nullptr ? node->m_next->m_prev : m_tail) = node->m_prev;
+            node->m_next = node->m_prev = nullptr;
+        }
+        m_size -= static_cast<unsigned int>(changed.size());
+
+        // update them and put them back. if something throws, the nodes still go back into the list
+        const auto comesFirst = [this](const Node* lhs, const Node* rhs) {
+            return comesBefore(lhs->m_data, rhs->m_data);
+        };
+        try {
+            for (Node* node : changed) {
+                node->m_data = applyFunction(static_cast<const T&>(node->m_data));
+            }
+            std::stable_sort(changed.begin(), changed.end(), comesFirst);
+        }
+        catch (...) {
+            for (Node* node : changed) {
+                node->m_next = node->m_prev = nullptr;
+                linkPlain(node);
+                m_size++;
+            }
+            throw;
+        }
+
+        if (m_indexed && changed.size() * 16 < m_size) { // few changes - put each one back through the index
+            for (Node* node : changed) {
+                node->m_next = node->m_prev = nullptr;
+                try {
+                    linkIndexed(node);
+                }
+                catch (...) { // no memory for its index tower, the base level is enough to keep it
+                    linkPlain(node);
+                }
+                m_size++;
+            }
+            return *this;
+        }
+        for (std::size_t i = 1; i < changed.size(); ++i) {
+            changed[i - 1]->m_next = changed[i];
+            changed[i]->m_prev = changed[i - 1];
+        }
+        m_size += static_cast<unsigned int>(changed.size());
+        mergeChain(changed.front(), changed.back());
+        if (m_indexed) {
+            rebuildIndex();
+        }
+
+        return *this;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename Predicate>
+    FilteredView<SortedList<T, Compare, Allocator>, Predicate> SortedList<T, Compare, Allocator>::filtered(Predicate predicate) const {
+        return FilteredView<SortedList, Predicate>(*this, predicate);
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename Function>
+    TransformedView<SortedList<T, Compare, Allocator>, Function> SortedList<T, Compare, Allocator>::transformed(Function function) const {
+        return TransformedView<SortedList, Function>(*this, function);
+    }
+
     // methods for ConstIterator inside sortedList
 
-    template <typename T>
-    typename SortedList<T>::ConstIterator SortedList<T>::begin() const {
+    template <typename T, typename Compare, typename Allocator>
+    typename SortedList<T, Compare, Allocator>::ConstIterator SortedList<T, Compare, Allocator>::begin() const {
         return ConstIterator(m_head);
     }
 
-    template <typename T>
-    typename SortedList<T>::ConstIterator SortedList<T>::end() const {
+    template <typename T, typename Compare, typename Allocator>
+    typename SortedList<T, Compare, Allocator>::ConstIterator SortedList<T, Compare, Allocator>::end() const {
         return ConstIterator(nullptr);
     }
 
     // ---------------------------------- Node ---------------------------------- //
 
-    template <typename T>
-    SortedList<T>::Node::Node(const T& data, Node* next, Node* prev) : m_data(data), m_next(next), m_prev(prev) {}
+    template <typename T, typename Compare, typename Allocator>
+    template <typename... Args>
+    SortedList<T, Compare, Allocator>::Node::Node(Node* next, Node* prev, Args&&... args)
+        : m_data(std::forward<Args>(args)...), m_next(next), m_prev(prev), m_tower(nullptr), m_level(0) {}
 
     // -------------------------------- Iterator -------------------------------- //
 
     // constructors
 
-    template <typename T>
-    SortedList<T>::ConstIterator::ConstIterator(Node *node) : m_currentNode(node) {}
+    template <typename T, typename Compare, typename Allocator>
+    SortedList<T, Compare, Allocator>::ConstIterator::ConstIterator(Node *node) : m_currentNode(node) {}
 
     // operators
 
-    template <typename T>
-    const T& SortedList<T>::ConstIterator::operator*() const {
+    template <typename T, typename Compare, typename Allocator>
+    const T& SortedList<T, Compare, Allocator>::ConstIterator::operator*() const {
         if (m_currentNode == nullptr) {
             throw std::out_of_range("No data"); // incase we are out of range
         }
         return m_currentNode->m_data; // return the data inside the node that the iterator is pointing to
     }
 
-    template <typename T>
-    typename SortedList<T>::ConstIterator& SortedList<T>::ConstIterator::operator++() {
+    template <typename T, typename Compare, typename Allocator>
+    typename SortedList<T, Compare, Allocator>::ConstIterator& SortedList<T, Compare, Allocator>::ConstIterator::operator++() {
         if (m_currentNode == nullptr) {
             throw std::out_of_range("Out of range");
         }
@@ -304,15 +755,66 @@ namespace mtm {
         return *this;
     }
 
-    template <typename T>
-    bool SortedList<T>::ConstIterator::operator!=(const ConstIterator& other) const {
+    template <typename T, typename Compare, typename Allocator>
+    bool SortedList<T, Compare, Allocator>::ConstIterator::operator!=(const ConstIterator& other) const {
         return m_currentNode != other.m_currentNode;
     }
 
     // ---------------------------------- Helper ---------------------------------- //
 
-    template<typename T>
-    void SortedList<T>::clear(Node* headToDelete) {
+    template <typename T, typename Compare, typename Allocator>
+    bool SortedList<T, Compare, Allocator>::comesBefore(const T& lhs, const T& rhs) const {
+        return m_compare(lhs, rhs);
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    template <typename... Args>
+    typename SortedList<T, Compare, Allocator>::Node* SortedList<T, Compare, Allocator>::createNode(Node* next, Node* prev, Args&&... args) {
+        Node* memory = NodeAllocatorTraits::allocate(m_allocator, 1);
+        try { // if constructing the data fails, give the memory back
+            return new (memory) Node(next, prev, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            NodeAllocatorTraits::deallocate(m_allocator, memory, 1);
+            throw;
+        }
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::destroyNode(Node* node) noexcept {
+        destroyTower(node);
+        node->~Node();
+        NodeAllocatorTraits::deallocate(m_allocator, node, 1);
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::createTower(Node* node, unsigned int level) {
+        // the towers come from the same allocator as the nodes, rebound to their links
+        using LinkAllocator = typename NodeAllocatorTraits::template rebind_alloc<typename Node::Link>;
+        using LinkAllocatorTraits = std::allocator_traits<LinkAllocator>;
+        LinkAllocator linkAllocator(m_allocator);
+        typename Node::Link* tower = LinkAllocatorTraits::allocate(linkAllocator, level);
+        for (unsigned int i = 0; i < level; ++i) {
+            LinkAllocatorTraits::construct(linkAllocator, tower + i);
+        }
+        node->m_tower = tower;
+        node->m_level = level;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::destroyTower(Node* node) noexcept {
+        if (node->m_tower == nullptr) {
+            return;
+        }
+        using LinkAllocator = typename NodeAllocatorTraits::template rebind_alloc<typename Node::Link>;
+        LinkAllocator linkAllocator(m_allocator); // the links are trivial, there is nothing to destroy
+        std::allocator_traits<LinkAllocator>::deallocate(linkAllocator, node->m_tower, node->m_level);
+        node->m_tower = nullptr;
+        node->m_level = 0;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::clear(Node* headToDelete) {
         if (headToDelete == nullptr) {
             return;
         }
@@ -321,16 +823,122 @@ namespace mtm {
         while (cur) {
             Node* toDelete = cur;
             cur = cur->m_next;
-            delete toDelete;
+            destroyNode(toDelete);
         }
     }
 
-    template<typename T>
-    void SortedList<T>::copyList(Node *&newHead, Node *&newTail, const SortedList& other) {
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::linkNode(Node* newNode) {
+        if (m_indexed) {
+            linkIndexed(newNode);
+        }
+        else {
+            linkPlain(newNode);
+        }
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::linkPlain(Node* newNode) {
+        // links into the base level only, which is also valid for an indexed list - the index is just sparser
+        const T& newData = newNode->m_data;
+        if (m_head == nullptr) { // the list is empty
+            m_head = m_tail = newNode;
+        }
+        else if (comesBefore(newData, m_head->m_data)) { // insert into the first spot
+            newNode->m_next = m_head;
+            m_head->m_prev = newNode;
+            m_head = newNode;
+        }
+        else if (!comesBefore(newData, m_tail->m_data)) { // insert into the last spot
+            newNode->m_prev = m_tail;
+            m_tail->m_next = newNode;
+            m_tail = newNode;
+        }
+        else { // find where to insert
+            for (Node* cur = m_head; cur != nullptr; cur = cur->m_next) {
+                if (!comesBefore(newData, cur->m_data) && comesBefore(newData, cur->m_next->m_data)) {
+                    newNode->m_next = cur->m_next;
+                    newNode->m_prev = cur;
+                    cur->m_next = newNode;
+                    newNode->m_next->m_prev = newNode;
+                    break;
+                }
+            }
+        }
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::mergeChain(Node* otherHead, Node* otherTail) {
+        // merges a sorted chain of nodes (not in the index) into the list, equal elements of the list go first
+        if (m_head == nullptr) {
+            m_head = otherHead;
+            m_tail = otherTail;
+            return;
+        }
+        if (!comesBefore(otherHead->m_data, m_tail->m_data)) { // the whole chain goes after the list
+            m_tail->m_next = otherHead;
+            otherHead->m_prev = m_tail;
+            m_tail = otherTail;
+            return;
+        }
+
+        Node* mine = m_head;
+        Node* theirs = otherHead;
+        Node* newHead = nullptr;
+        Node* newTail = nullptr;
+        const auto append = [&newHead, &newTail](Node* node) {
+            node->m_prev = newTail;
+            if (newTail != nullptr) {
+                newTail->m_next = node;
+            }
+            else {
+                newHead = node;
+            }
+            newTail = node;
+        };
+        try {
+            while (mine != nullptr && theirs != nullptr) {
+                if (comesBefore(theirs->m_data, mine->m_data)) {
+                    Node* next = theirs->m_next;
+                    append(theirs);
+                    theirs = next;
+                }
+                else {
+                    Node* next = mine->m_next;
+                    append(mine);
+                    mine = next;
+                }
+            }
+        }
+        catch (...) { // a comparison failed - keep every node in the list, even if the order is lost
+            for (Node* rest : {mine, theirs}) {
+                while (rest != nullptr) {
+                    Node* next = rest->m_next;
+                    append(rest);
+                    rest = next;
+                }
+            }
+            newTail->m_next = nullptr;
+            m_head = newHead;
+            m_tail = newTail;
+            throw;
+        }
+        Node* rest = mine != nullptr ? mine : theirs;
+        newTail->m_next = rest;
+        if (rest != nullptr) {
+            rest->m_prev = newTail;
+            newTail = mine != nullptr ? m_tail : otherTail;
+        }
+        m_head = newHead;
+        m_tail = newTail;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::copyList(Node *&newHead, Node *&newTail, const SortedList& other) {
         try { // if an allocation fails
             Node* prev = nullptr;
             for (ConstIterator It = other.begin(); It != other.end(); ++It) {
-                Node* newNode = new Node(*It, nullptr, nullptr);
+                Node* newNode = createNode(nullptr, nullptr, *It);
                 if (newHead == nullptr) {
                     newHead = newNode;
                 }
@@ -347,5 +955,341 @@ namespace mtm {
             throw;
         }
     }
-}
 
+    // ------------------------------- Index Helper ------------------------------- //
+
+    template <typename T, typename Compare, typename Allocator>
+    unsigned int SortedList<T, Compare, Allocator>::randomLevel() {
+        // xorshift, each extra level is kept with probability 1/4
+        unsigned int level = 0;
+        do {
+            m_randomState ^= m_randomState << 13;
+            m_randomState ^= m_randomState >> 17;
+            m_randomState ^= m_randomState << 5;
+            if ((m_randomState & 3u) != 0) {
+                break;
+            }
+            ++level;
+        } while (level < MAX_INDEX_LEVEL);
+        return level;
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::linkIndexed(Node* newNode) {
+        // find the last node on every level that newNode doesn't come before, equal elements keep their order
+        const T& newData = newNode->m_data;
+        Node* update[MAX_INDEX_LEVEL] = {};
+        Node* pred = nullptr;
+        for (unsigned int level = m_indexLevel; level > 0; --level) {
+            Node* next = pred == nullptr ? m_indexHead[level - 1] : pred->m_tower[level - 1].m_next;
+            while (next != nullptr && !comesBefore(newData, next->m_data)) {
+                pred = next;
+                next = next->m_tower[level - 1].m_next;
+            }
+            update[level - 1] = pred;
+        }
+        Node* next = pred == nullptr ? m_head : pred->m_next;
+        while (next != nullptr && !comesBefore(newData, next->m_data)) {
+            pred = next;
+            next = next->m_next;
+        }
+
+        const unsigned int newLevel = randomLevel();
+        if (newLevel > 0) {
+            createTower(newNode, newLevel);
+        }
+
+        // link into the base level
+        newNode->m_next = next;
+        newNode->m_prev = pred;
+        if (pred != nullptr) {
+            pred->m_next = newNode;
+        }
+        else {
+            m_head = newNode;
+        }
+        if (next != nullptr) {
+            next->m_prev = newNode;
+        }
+        else {
+            m_tail = newNode;
+        }
+
+        // link into the index levels, new levels start out empty so update is already nullptr there
+        for (unsigned int level = 0; level < newLevel; ++level) {
+            Node* prevOnLevel = update[level];
+            Node* nextOnLevel = prevOnLevel == nullptr ? m_indexHead[level] : prevOnLevel->m_tower[level].m_next;
+            newNode->m_tower[level].m_next = nextOnLevel;
+            newNode->m_tower[level].m_prev = prevOnLevel;
+            if (nextOnLevel != nullptr) {
+                nextOnLevel->m_tower[level].m_prev = newNode;
+            }
+            if (prevOnLevel != nullptr) {
+                prevOnLevel->m_tower[level].m_next = newNode;
+            }
+            else {
+                m_indexHead[level] = newNode;
+            }
+        }
+        if (newLevel > m_indexLevel) {
+            m_indexLevel = newLevel;
+        }
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::unlinkFromIndex(Node* node) noexcept {
+        for (unsigned int level = 0; level < node->m_level; ++level) {
+            Node* prevOnLevel = node->m_tower[level].m_prev;
+            Node* nextOnLevel = node->m_tower[level].m_next;
+            if (prevOnLevel != nullptr) {
+                prevOnLevel->m_tower[level].m_next = nextOnLevel;
+            }
+            else {
+                m_indexHead[level] = nextOnLevel;
+            }
+            if (nextOnLevel != nullptr) {
+                nextOnLevel->m_tower[level].m_prev = prevOnLevel;
+            }
+        }
+        while (m_indexLevel > 0 && m_indexHead[m_indexLevel - 1] == nullptr) {
+            --m_indexLevel;
+        }
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::dropIndex() noexcept {
+        for (Node* cur = m_head; cur != nullptr; cur = cur->m_next) {
+            destroyTower(cur);
+        }
+        m_indexLevel = 0;
+        std::fill(m_indexHead, m_indexHead + MAX_INDEX_LEVEL, nullptr);
+    }
+
+    template <typename T, typename Compare, typename Allocator>
+    void SortedList<T, Compare, Allocator>::rebuildIndex() {
+        // build a perfectly balanced index in one pass - every 4th node gets level 1, every 16th level 2, ...
+        dropIndex();
+        Node* lastOnLevel[MAX_INDEX_LEVEL] = {};
+        unsigned int position = 0;
+        try {
+            for (Node* cur = m_head; cur != nullptr; cur = cur->m_next) {
+                unsigned int level = 0;
+                for (unsigned int rest = ++position; rest % 4 == 0 && level < MAX_INDEX_LEVEL; rest /= 4) {
+                    ++level;
+                }
+                if (level == 0) {
+                    continue;
+                }
+                createTower(cur, level);
+                for (unsigned int i = 0; i < level; ++i) {
+                    cur->m_tower[i].m_prev = lastOnLevel[i];
+                    cur->m_tower[i].m_next = nullptr;
+                    if (lastOnLevel[i] != nullptr) {
+                        lastOnLevel[i]->m_tower[i].m_next = cur;
+                    }
+                    else {
+                        m_indexHead[i] = cur;
+                    }
+                    lastOnLevel[i] = cur;
+                }
+                if (level > m_indexLevel) {
+                    m_indexLevel = level;
+                }
+            }
+        }
+        catch (...) { // leave the list without an index rather than with half of one
+            dropIndex();
+            throw;
+        }
+    }
+
+    // ---------------------------------- Views ---------------------------------- //
+
+    /**
+     * FilteredView - the elements of a container that satisfy a predicate, found while iterating.
+     * the elements are not copied, so the view stays sorted and its iterators return references into the container.
+     * toList() builds a container of the same type, ordered by the same Compare object as the source.
+     */
+    template <typename Container, typename Predicate>
+    class FilteredView {
+        using SourceIterator = typename Container::ConstIterator;
+
+        const Container* m_source;
+        Predicate m_predicate;
+
+    public:
+        class ConstIterator {
+            friend FilteredView;
+
+            SourceIterator m_current;
+            SourceIterator m_end;
+            const Predicate* m_predicate;
+
+            ConstIterator(SourceIterator current, SourceIterator end, const Predicate* predicate);
+            void skipRejected();
+
+        public:
+            decltype(*std::declval<SourceIterator>()) operator*() const;
+            ConstIterator& operator++();
+            bool operator!=(const ConstIterator& other) const;
+        };
+
+        FilteredView(const Container& source, Predicate predicate);
+
+        ConstIterator begin() const;
+
+        ConstIterator end() const;
+
+        Container toList() const;
+    };
+
+    /**
+     * TransformedView - the results of a function on every element of a container, computed while iterating.
+     * the results come in the order of the container, which is not necessarily sorted. toList() checks that
+     * in one pass and only sorts when the function actually changed the order.
+     * the results may have another type than the elements, so the source's Compare object and storage are not
+     * carried over: toList() builds a SortedList<value_type> with the default policies, toList<List>() builds a
+     * list of the given type, and toList<List>(compare) also gives it the Compare object to order it by.
+     */
+    template <typename Container, typename Function>
+    class TransformedView {
+        using SourceIterator = typename Container::ConstIterator;
+        using Result = decltype(std::declval<const Function&>()(*std::declval<SourceIterator>()));
+
+        const Container* m_source;
+        Function m_function;
+
+    public:
+        using value_type = typename std::decay<Result>::type;
+
+        class ConstIterator {
+            friend TransformedView;
+
+            SourceIterator m_current;
+            const Function* m_function;
+
+            ConstIterator(SourceIterator current, const Function* function);
+
+        public:
+            Result operator*() const;
+            ConstIterator& operator++();
+            bool operator!=(const ConstIterator& other) const;
+        };
+
+        TransformedView(const Container& source, Function function);
+
+        ConstIterator begin() const;
+
+        ConstIterator end() const;
+
+        template <typename List = SortedList<value_type>>
+        List toList() const;
+
+        template <typename List, typename ListCompare>
+        List toList(const ListCompare& compare) const;
+    };
+
+    // FilteredView
+
+    template <typename Container, typename Predicate>
+    FilteredView<Container, Predicate>::FilteredView(const Container& source, Predicate predicate)
+        : m_source(&source), m_predicate(predicate) {}
+
+    template <typename Container, typename Predicate>
+    typename FilteredView<Container, Predicate>::ConstIterator FilteredView<Container, Predicate>::begin() const {
+        return ConstIterator(m_source->begin(), m_source->end(), &m_predicate);
+    }
+
+    template <typename Container, typename Predicate>
+    typename FilteredView<Container, Predicate>::ConstIterator FilteredView<Container, Predicate>::end() const {
+        return ConstIterator(m_source->end(), m_source->end(), &m_predicate);
+    }
+
+    template <typename Container, typename Predicate>
+    Container FilteredView<Container, Predicate>::toList() const {
+        return Container(begin(), end(), m_source->getCompare());
+    }
+
+    template <typename Container, typename Predicate>
+    FilteredView<Container, Predicate>::ConstIterator::ConstIterator(SourceIterator current, SourceIterator end,
+                                                                     const Predicate* predicate)
+        : m_current(current), m_end(end), m_predicate(predicate) {
+        skipRejected();
+    }
+
+    template <typename Container, typename Predicate>
+    void FilteredView<Container, Predicate>::ConstIterator::skipRejected() {
+        while (m_current != m_end && !(*m_predicate)(*m_current)) {
+            ++m_current;
+        }
+    }
+
+    template <typename Container, typename Predicate>
+    decltype(*std::declval<typename Container::ConstIterator>())
+    FilteredView<Container, Predicate>::ConstIterator::operator*() const {
+        return *m_current;
+    }
+
+    template <typename Container, typename Predicate>
+    typename FilteredView<Container, Predicate>::ConstIterator&
+    FilteredView<Container, Predicate>::ConstIterator::operator++() {
+        ++m_current; // throws like the container's iterator when already at the end
+        skipRejected();
+        return *this;
+    }
+
+    template <typename Container, typename Predicate>
+    bool FilteredView<Container, Predicate>::ConstIterator::operator!=(const ConstIterator& other) const {
+        return m_current != other.m_current;
+    }
+
+    // TransformedView
+
+    template <typename Container, typename Function>
+    TransformedView<Container, Function>::TransformedView(const Container& source, Function function)
+        : m_source(&source), m_function(function) {}
+
+    template <typename Container, typename Function>
+    typename TransformedView<Container, Function>::ConstIterator TransformedView<Container, Function>::begin() const {
+        return ConstIterator(m_source->begin(), &m_function);
+    }
+
+    template <typename Container, typename Function>
+    typename TransformedView<Container, Function>::ConstIterator TransformedView<Container, Function>::end() const {
+        return ConstIterator(m_source->end(), &m_function);
+    }
+
+    template <typename Container, typename Function>
+    template <typename List>
+    List TransformedView<Container, Function>::toList() const {
+        return List(begin(), end());
+    }
+
+    template <typename Container, typename Function>
+    template <typename List, typename ListCompare>
+    List TransformedView<Container, Function>::toList(const ListCompare& compare) const {
+        return List(begin(), end(), compare);
+    }
+
+    template <typename Container, typename Function>
+    TransformedView<Container, Function>::ConstIterator::ConstIterator(SourceIterator current, const Function* function)
+        : m_current(current), m_function(function) {}
+
+    template <typename Container, typename Function>
+    typename TransformedView<Container, Function>::Result
+    TransformedView<Container, Function>::ConstIterator::operator*() const {
+        return (*m_function)(*m_current);
+    }
+
+    template <typename Container, typename Function>
+    typename TransformedView<Container, Function>::ConstIterator&
+    TransformedView<Container, Function>::ConstIterator::operator++() {
+        ++m_current;
+        return *this;
+    }
+
+    template <typename Container, typename Function>
+    bool TransformedView<Container, Function>::ConstIterator::operator!=(const ConstIterator& other) const {
+        return m_current != other.m_current;
+    }
+}
@@ -1,31 +1,54 @@
 
 #include "Task.h"
+#include <charconv>
+#include <cstring>
 
 // Constructor
 Task::Task(int priority, TaskType type, const string &desc)
-    : m_description(desc), m_priority(priority), m_type(type)
+    : Task(priority, type, InternedString(desc)) {}
+
+Task::Task(int priority, TaskType type, InternedString desc)
+    : m_id(0), m_description(std::move(desc)), m_priority(priority), m_type(type)
 {
     // enforce priority range of 0-100
     // 0 is lowest priority, 100 is highest
-    if (m_priority < 0)
+    if (m_priority < MIN_PRIORITY)
     {
-        m_priority = 0;
+        m_priority = MIN_PRIORITY;
     }
-    else if (m_priority > 100)
+    else if (m_priority > MAX_PRIORITY)
     {
-        m_priority = 100;
+        m_priority = MAX_PRIORITY;
     }
 }
 
 Task::Task(int priority, const string &desc)
     : Task(priority, TaskType::General, desc) {}
 
+// Formats "Task ID: <id>, Priority: <priority>, Type: <type>, Description: " - everything but the description
+std::size_t Task::formatHeader(char* header, TaskId id, int priority, TaskType type) {
+    char* const end = header + MAX_HEADER_LENGTH;
+    char* cur = header;
+    const auto append = [&cur](std::string_view text) {
+        std::memcpy(cur, text.data(), text.size());
+        cur += text.size();
+    };
+    append("Task ID: ");
+    cur = std::to_chars(cur, end, id).ptr;
+    append(", Priority: ");
+    cur = std::to_chars(cur, end, priority).ptr;
+    append(", Type: ");
+    append(taskTypeName(type));
+    append(", Description: ");
+    return cur - header;
+}
+
 // Getters and setters
-int Task::getId() const {
+TaskId Task::getId() const {
     return m_id;
 }
 
-void Task::setId(int newId) {
+void Task::setId(TaskId newId) {
     m_id = newId;
 }
 
@@ -33,7 +56,11 @@ TaskType Task::getType() const {
     return m_type;
 }
 
-string Task::getDescription() const {
+const string& Task::getDescription() const {
+    return m_description.str();
+}
+
+const InternedString& Task::getInternedDescription() const {
     return m_description;
 }
 
@@ -42,10 +69,25 @@ int Task::getPriority() const {
 }
 
 
+std::size_t Task::format(char* buffer, std::size_t size) const {
+    char header[MAX_HEADER_LENGTH];
+    const std::size_t headerLength = formatHeader(header, m_id, m_priority, m_type);
+    const string& description = m_description.str();
+    const std::size_t length = headerLength + description.size();
+    if (length <= size) {
+        std::memcpy(buffer, header, headerLength);
+        std::memcpy(buffer + headerLength, description.data(), description.size());
+    }
+    return length;
+}
+
+
 // Overloaded operators
 ostream &operator<<(ostream& os, const Task& task) {
-    os << "Task ID: " << task.m_id << ", Priority: " << task.m_priority;
-    os << ", Type: " << taskTypeToString(task.m_type) << ", Description: " << task.m_description;
+    char header[Task::MAX_HEADER_LENGTH];
+    os.write(header, Task::formatHeader(header, task.m_id, task.m_priority, task.m_type));
+    const string& description = task.m_description.str();
+    os.write(description.data(), description.size());
     return os;
 }
 
@@ -59,28 +101,5 @@ bool operator>(const Task& lhs, const Task& rhs) {
 
 // Convert TaskType to string
 std::string taskTypeToString(TaskType type) {
-    switch (type) {
-    case TaskType::Meeting:
-        return "Meeting";
-    case TaskType::Presentation:
-        return "Presentation";
-    case TaskType::Documentation:
-        return "Documentation";
-    case TaskType::Development:
-        return "Development";
-    case TaskType::Testing:
-        return "Testing";
-    case TaskType::Research:
-        return "Research";
-    case TaskType::Training:
-        return "Training";
-    case TaskType::Maintenance:
-        return "Maintenance";
-    case TaskType::CustomerSupport:
-        return "Customer Support";
-    case TaskType::General:
-        return "General";
-    default:
-        return "Unknown Task";
-    }
+    return string(taskTypeName(type));
 }
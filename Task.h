@@ -1,8 +1,14 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <utility>
+#include "InternedString.h"
 
 using std::ostream;
 using std::string;
@@ -23,6 +29,38 @@ enum class TaskType {
     General
 };
 
+/**
+ * @brief The type of task IDs - 64 bits, so a long-running program never runs out of them.
+ */
+using TaskId = std::int64_t;
+
+/**
+ * @brief The names of the task types, in the order of the TaskType enum.
+ */
+inline constexpr std::string_view TASK_TYPE_NAMES[] = {
+    "Meeting",
+    "Presentation",
+    "Documentation",
+    "Development",
+    "Testing",
+    "Research",
+    "Training",
+    "Maintenance",
+    "Customer Support",
+    "General"
+};
+
+/**
+ * @brief Gets the name of a TaskType without building a string.
+ *
+ * @param type The TaskType whose name is needed.
+ * @return std::string_view The name of the TaskType, or "Unknown Task" if it isn't one of the types.
+ */
+constexpr std::string_view taskTypeName(TaskType type) {
+    const std::size_t index = static_cast<std::size_t>(type);
+    return index < sizeof(TASK_TYPE_NAMES) / sizeof(TASK_TYPE_NAMES[0]) ? TASK_TYPE_NAMES[index] : "Unknown Task";
+}
+
 /**
  * @brief Converts a TaskType enum to its corresponding string representation.
  *
@@ -35,12 +73,22 @@ string taskTypeToString(TaskType type);
  * @brief Class representing a task.
  */
 class Task {
+public:
+    /**
+     * @brief The range of task priorities, the constructor clamps every priority into it.
+     */
+    static const int MIN_PRIORITY = 0;
+    static const int MAX_PRIORITY = 100;
+
 private:
-    int m_id;
-    string m_description;
+    TaskId m_id;
+    InternedString m_description; // shared with every task that has the same description
     int m_priority;
     TaskType m_type;
 
+    static const std::size_t MAX_HEADER_LENGTH = 96; // fits the longest ID, priority and type name with the labels
+    static std::size_t formatHeader(char* header, TaskId id, int priority, TaskType type);
+
 public:
     /**
      * @brief Constructor to create a Task object.
@@ -51,6 +99,15 @@ public:
      */
     Task(int priority, TaskType type = TaskType::General, const string& desc = "");
 
+    /**
+     * @brief Constructor to create a Task object with a description that is already interned, without copying it.
+     *
+     * @param priority The priority of the task, enforced to be in range [0, 100].
+     * @param type The type of the task.
+     * @param desc The interned description of the task.
+     */
+    Task(int priority, TaskType type, InternedString desc);
+
     /**
      * @brief Constructor to create a Task object with a default type.
      *
@@ -62,23 +119,30 @@ public:
     /**
      * @brief Gets the ID of the task.
      *
-     * @return int The ID of the task.
+     * @return TaskId The ID of the task.
      */
-    int getId() const;
+    TaskId getId() const;
 
     /**
      * @brief Sets the ID of the task.
      *
      * @param newId The new ID to be set for the task.
      */
-    void setId(int newId);
+    void setId(TaskId newId);
 
     /**
      * @brief Gets the description of the task.
      *
-     * @return string The description of the task.
+     * @return const string& The description of the task, kept once for all the tasks that have it.
      */
-    string getDescription() const;
+    const string& getDescription() const;
+
+    /**
+     * @brief Gets the interned description of the task, for creating tasks with the same description cheaply.
+     *
+     * @return const InternedString& The interned description of the task.
+     */
+    const InternedString& getInternedDescription() const;
 
     /**
      * @brief Gets the priority of the task.
@@ -94,6 +158,17 @@ public:
      */
     TaskType getType() const;
 
+    /**
+     * @brief Writes the Task details into a character buffer, the same way operator<< prints them.
+     *
+     * Nothing is allocated. The buffer is only written to if the whole text fits, and it isn't null terminated.
+     *
+     * @param buffer The buffer to write into.
+     * @param size The size of the buffer.
+     * @return std::size_t The length of the text - if it's larger than size, nothing was written.
+     */
+    std::size_t format(char* buffer, std::size_t size) const;
+
     /**
      * @brief Overloaded output stream operator for printing Task details.
      *
@@ -112,4 +187,51 @@ public:
      * @return false If the priority of lhs is not greater than that of rhs.
      */
     friend bool operator>(const Task& lhs, const Task& rhs);
+
+    friend struct TaskOrderKey;
+    friend struct TaskIdKey;
+    friend struct TaskPriorityKey;
+};
+
+/**
+ * @brief Key function that pairs the priority of a task with its ID turned into an unsigned order.
+ *
+ * A higher priority gives a bigger key, and between equal priorities a lower ID gives a bigger key, so comparing
+ * keys with std::greater gives exactly the order of operator>. Defined here so comparisons can be inlined.
+ */
+struct TaskOrderKey {
+    std::pair<int, std::uint64_t> operator()(const Task& task) const {
+        const std::uint64_t idOrder = ~(static_cast<std::uint64_t>(task.m_id) ^ 0x8000000000000000u);
+        return std::pair<int, std::uint64_t>(task.m_priority, idOrder);
+    }
 };
+
+/**
+ * @brief Key function that returns the ID of a task, for keeping tasks ordered by ID.
+ */
+struct TaskIdKey {
+    TaskId operator()(const Task& task) const {
+        return task.m_id;
+    }
+};
+
+/**
+ * @brief Key function that returns the priority of a task, for keeping tasks in priority buckets.
+ */
+struct TaskPriorityKey {
+    int operator()(const Task& task) const {
+        return task.m_priority;
+    }
+};
+
+namespace std {
+    /**
+     * @brief The default order of SortedList<Task> - the same order as operator>, compared through TaskOrderKey.
+     */
+    template <>
+    struct greater<Task> {
+        bool operator()(const Task& lhs, const Task& rhs) const {
+            return TaskOrderKey()(lhs) > TaskOrderKey()(rhs);
+        }
+    };
+}
@@ -0,0 +1,132 @@
+#include "TaskExecutor.h"
+#include <vector>
+
+TaskExecutor::TaskExecutor(TaskManager& manager, unsigned int numOfWorkers)
+    : m_manager(manager), m_workers(new Worker[numOfWorkers > 0 ? numOfWorkers : 1]),
+      m_numOfWorkers(numOfWorkers > 0 ? numOfWorkers : 1), m_remaining(0), m_steals(0), m_numOfFailed(0),
+      m_failed(false) {}
+
+void TaskExecutor::addPerson(PersonId personId) {
+    m_manager.getPerson(personId); // throws if there is no such person
+    m_persons.push_back(personId);
+    try {
+        m_workers[(m_persons.size() - 1) % m_numOfWorkers].m_persons.push_back(personId);
+    }
+    catch (...) {
+        m_persons.pop_back();
+        throw;
+    }
+}
+
+unsigned long long TaskExecutor::run(const Job& job) {
+    unsigned long long numOfTasks = 0;
+    for (PersonId personId : m_persons) {
+        numOfTasks += m_manager.getPerson(personId).getTasks().length();
+    }
+    m_remaining.store(numOfTasks);
+    m_numOfFailed.store(0);
+    m_failed.store(false);
+    m_error = nullptr;
+
+    std::vector<std::thread> threads;
+    threads.reserve(m_numOfWorkers - 1);
+    try {
+        for (unsigned int i = 1; i < m_numOfWorkers; ++i) {
+            threads.emplace_back(&TaskExecutor::work, this, i, std::cref(job));
+        }
+    }
+    catch (...) { // couldn't start another thread, the ones already running are enough
+    }
+    work(0, job); // the calling thread is worker 0
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+    return numOfTasks - m_remaining.load();
+}
+
+unsigned long long TaskExecutor::failed() const {
+    return m_numOfFailed.load(std::memory_order_relaxed);
+}
+
+unsigned long long TaskExecutor::steals() const {
+    return m_steals.load(std::memory_order_relaxed);
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+void TaskExecutor::work(unsigned int index, const Job& job) {
+    PersonId personId = 0;
+    while (m_remaining.load(std::memory_order_acquire) > 0 && !m_failed.load(std::memory_order_relaxed)) {
+        if (!take(index, personId)) { // the remaining tasks are being run by other workers right now
+            std::this_thread::yield();
+            continue;
+        }
+        if (runTurn(m_manager.getPerson(personId), job)) {
+            giveBack(index, personId);
+        }
+    }
+}
+
+bool TaskExecutor::runTurn(const Person& person, const Job& job) {
+    // only this worker changes the person's tasks, so they are read without the lock until they are completed
+    TaskId succeeded[TASKS_PER_TURN];
+    int numOfSucceeded = 0;
+    const string& personName = person.getName();
+    const Person::TaskQueue& tasks = person.getTasks();
+    for (auto it = tasks.begin(); numOfSucceeded < TASKS_PER_TURN && it != tasks.end(); ++it) {
+        try {
+            job(personName, *it);
+        }
+        catch (...) { // the task stays assigned
+            m_numOfFailed.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+            m_failed.store(true, std::memory_order_relaxed);
+            break;
+        }
+        succeeded[numOfSucceeded++] = (*it).getId();
+    }
+
+    std::lock_guard<std::mutex> lock(m_managerMutex);
+    for (int i = 0; i < numOfSucceeded; ++i) {
+        m_manager.completeTaskById(succeeded[i]);
+    }
+    m_remaining.fetch_sub(numOfSucceeded, std::memory_order_release);
+    return tasks.length() > 0;
+}
+
+bool TaskExecutor::take(unsigned int index, PersonId& personId) {
+    {
+        Worker& own = m_workers[index];
+        std::lock_guard<std::mutex> lock(own.m_mutex);
+        if (!own.m_persons.empty()) {
+            personId = own.m_persons.front();
+            own.m_persons.pop_front();
+            return true;
+        }
+    }
+    // steal from the back, the person the other worker would get to last
+    for (unsigned int offset = 1; offset < m_numOfWorkers; ++offset) {
+        Worker& victim = m_workers[(index + offset) % m_numOfWorkers];
+        std::lock_guard<std::mutex> lock(victim.m_mutex);
+        if (!victim.m_persons.empty()) {
+            personId = victim.m_persons.back();
+            victim.m_persons.pop_back();
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskExecutor::giveBack(unsigned int index, PersonId personId) {
+    Worker& own = m_workers[index];
+    std::lock_guard<std::mutex> lock(own.m_mutex);
+    own.m_persons.push_back(personId);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Person.h"
+#include "Task.h"
+#include "TaskManager.h"
+
+/**
+ * @brief Pool of worker threads that runs the tasks of the persons of a TaskManager, highest priority first.
+ *
+ * Every worker owns a queue of persons. It takes the person at the front, runs the job for a few of their tasks,
+ * completes the ones whose job succeeded in the TaskManager, and puts the person back at the end of its queue if
+ * they have more. A worker whose queue is empty steals the person at the back of another worker's queue, so all
+ * workers stay busy even when the tasks are spread unevenly.
+ *
+ * A person is only ever held by one worker, so the tasks of one person run one at a time, in priority order.
+ * Tasks of different persons run in parallel, and the job must be safe to call from many threads. The jobs run
+ * without any lock, only completing the tasks of a turn takes the TaskManager's lock.
+ *
+ * While run is running, the workers are the only threads that may use the TaskManager.
+ */
+class TaskExecutor {
+public:
+    /**
+     * @brief The work done for every task: the name of the person and the task itself.
+     */
+    using Job = std::function<void(const string& personName, const Task& task)>;
+
+    /**
+     * @brief The number of tasks a worker runs for a person before moving on to the next person.
+     */
+    static const int TASKS_PER_TURN = 16;
+
+private:
+    struct alignas(64) Worker { // every queue lock on its own cache line
+        std::mutex m_mutex;
+        std::deque<PersonId> m_persons;
+    };
+
+    TaskManager& m_manager;
+    std::mutex m_managerMutex; // completing tasks changes lists shared by all the persons
+    std::vector<PersonId> m_persons;
+    std::unique_ptr<Worker[]> m_workers;
+    unsigned int m_numOfWorkers;
+
+    std::atomic<unsigned long long> m_remaining;
+    std::atomic<unsigned long long> m_steals;
+    std::atomic<unsigned long long> m_numOfFailed;
+    std::atomic<bool> m_failed;
+    std::mutex m_errorMutex;
+    std::exception_ptr m_error;
+
+    void work(unsigned int index, const Job& job);
+    bool runTurn(const Person& person, const Job& job);
+    bool take(unsigned int index, PersonId& personId);
+    void giveBack(unsigned int index, PersonId personId);
+
+public:
+    /**
+     * @brief Constructor to create a TaskExecutor object that runs the tasks of a TaskManager.
+     *
+     * @param manager The TaskManager whose tasks are run and completed, it must outlive the executor.
+     * @param numOfWorkers The number of worker threads, at least one.
+     */
+    explicit TaskExecutor(TaskManager& manager, unsigned int numOfWorkers = std::thread::hardware_concurrency());
+
+    /**
+     * @brief Deleted copy constructor to prevent copying of TaskExecutor objects.
+     */
+    TaskExecutor(const TaskExecutor& other) = delete;
+
+    /**
+     * @brief Deleted copy assignment operator to prevent assignment of TaskExecutor objects.
+     */
+    TaskExecutor& operator=(const TaskExecutor& other) = delete;
+
+    /**
+     * @brief Adds a person of the TaskManager whose tasks will be run. The persons are dealt to the workers in turn.
+     *
+     * Must not be called while run is running, and a person must only be added once.
+     *
+     * @param personId The ID of the person, as returned by TaskManager::registerPerson.
+     * @throw std::runtime_error If there is no person with this ID.
+     */
+    void addPerson(PersonId personId);
+
+    /**
+     * @brief Runs all the tasks of all the persons and returns when they are done.
+     *
+     * A task is completed in the TaskManager only after its job returned. If a job throws, its task stays
+     * assigned and is counted in failed(), the workers stop after the jobs they are running, and the first
+     * exception is thrown from run. The tasks that weren't run are still assigned to their persons too.
+     *
+     * @param job The work done for every task.
+     * @return unsigned long long The number of tasks whose job succeeded and that were completed.
+     */
+    unsigned long long run(const Job& job);
+
+    /**
+     * @brief The number of jobs that threw in the last run, their tasks are still assigned.
+     */
+    unsigned long long failed() const;
+
+    /**
+     * @brief The number of times a worker took a person from another worker's queue.
+     */
+    unsigned long long steals() const;
+};
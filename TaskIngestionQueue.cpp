@@ -0,0 +1,157 @@
+#include "TaskIngestionQueue.h"
+#include <exception>
+#include <utility>
+
+namespace {
+    // how many times the applier finds the queue empty and yields before it goes to sleep
+    const int IDLE_YIELDS = 1024;
+}
+
+TaskIngestionQueue::TaskIngestionQueue(TaskManager& manager, std::size_t capacity)
+    : m_manager(manager), m_ring(capacity), m_stopping(false), m_applierWaiting(false), m_submitted(0), m_dropped(0),
+      m_backpressureWaits(0), m_applied(0), m_failed(0) {
+    m_batch.reserve(DEFAULT_BATCH_SIZE);
+}
+
+TaskIngestionQueue::~TaskIngestionQueue() {
+    stopApplier();
+}
+
+bool TaskIngestionQueue::trySubmit(const string& personName, const Task& task) {
+    Record record{personName, task}; // copied before the ring is touched, the push itself can't fail halfway
+    if (!m_ring.tryPush(std::move(record))) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+    wakeApplier();
+    return true;
+}
+
+void TaskIngestionQueue::submit(const string& personName, const Task& task) {
+    Record record{personName, task};
+    while (!m_ring.tryPush(std::move(record))) { // a failed push leaves the record as it was
+        m_backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::yield();
+    }
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+    wakeApplier();
+}
+
+std::size_t TaskIngestionQueue::drain(std::size_t maxBatch) {
+    m_batch.clear();
+    Record record{string(), Task(0, TaskType::General)};
+    while (m_batch.size() < maxBatch && m_ring.tryPop(record)) {
+        m_batch.push_back(std::move(record));
+    }
+
+    // records that follow each other for the same person are assigned together, the IDs stay in arrival order
+    std::vector<Task> tasks;
+    std::size_t first = 0;
+    while (first < m_batch.size()) {
+        std::size_t last = first + 1;
+        while (last < m_batch.size() && m_batch[last].m_personName == m_batch[first].m_personName) {
+            ++last;
+        }
+        tasks.clear();
+        for (std::size_t i = first; i < last; ++i) {
+            tasks.push_back(std::move(m_batch[i].m_task));
+        }
+        try {
+            // also a single record, so a record that fails never takes an ID, however the records were batched
+            m_manager.assignTasks(m_batch[first].m_personName, tasks);
+            m_applied.fetch_add(tasks.size(), std::memory_order_relaxed);
+        }
+        catch (const std::exception&) { // e.g. no room for a new person, the rest of the batch is still applied
+            m_failed.fetch_add(tasks.size(), std::memory_order_relaxed);
+        }
+        first = last;
+    }
+    return m_batch.size();
+}
+
+void TaskIngestionQueue::startApplier() {
+    if (m_applier.joinable()) {
+        return;
+    }
+    m_stopping.store(false, std::memory_order_relaxed);
+    m_applier = std::thread(&TaskIngestionQueue::applyUntilStopped, this);
+}
+
+void TaskIngestionQueue::stopApplier() {
+    if (!m_applier.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping.store(true, std::memory_order_release);
+    }
+    m_wakeup.notify_one();
+    m_applier.join();
+}
+
+std::size_t TaskIngestionQueue::depth() const {
+    return m_ring.size();
+}
+
+unsigned long long TaskIngestionQueue::submitted() const {
+    return m_submitted.load(std::memory_order_relaxed);
+}
+
+unsigned long long TaskIngestionQueue::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+unsigned long long TaskIngestionQueue::backpressureWaits() const {
+    return m_backpressureWaits.load(std::memory_order_relaxed);
+}
+
+unsigned long long TaskIngestionQueue::applied() const {
+    return m_applied.load(std::memory_order_relaxed);
+}
+
+unsigned long long TaskIngestionQueue::failed() const {
+    return m_failed.load(std::memory_order_relaxed);
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+void TaskIngestionQueue::applyUntilStopped() {
+    int idle = 0;
+    while (!m_stopping.load(std::memory_order_acquire)) {
+        if (drain() > 0) {
+            idle = 0;
+        }
+        else if (++idle < IDLE_YIELDS) {
+            std::this_thread::yield();
+        }
+        else {
+            waitForRecords();
+            idle = 0;
+        }
+    }
+    while (drain() > 0) { // everything submitted before the stop is still applied
+    }
+}
+
+void TaskIngestionQueue::waitForRecords() {
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_applierWaiting.store(true, std::memory_order_relaxed);
+    // pairs with the fence in wakeApplier - either the producer sees the flag, or the applier sees its record
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    m_wakeup.wait(lock, [this]() {
+        return m_stopping.load(std::memory_order_acquire) || m_ring.size() > 0;
+    });
+    m_applierWaiting.store(false, std::memory_order_relaxed);
+}
+
+void TaskIngestionQueue::wakeApplier() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_applierWaiting.load(std::memory_order_relaxed)) { // the applier is busy, it will find the record
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+    }
+    m_wakeup.notify_one();
+}
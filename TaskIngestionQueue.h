@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MpscRing.h"
+#include "Task.h"
+#include "TaskManager.h"
+
+/**
+ * @brief Lock-free front end that lets many threads assign tasks to one TaskManager.
+ *
+ * Producer threads submit (person name, task) records into a lock-free ring without ever taking a lock, and a
+ * single applier thread drains the ring in batches into the TaskManager. Tasks get their IDs when they are
+ * applied, in the order they were submitted, and tasks submitted one after the other for the same person are
+ * assigned together with TaskManager::assignTasks. When the queue stays empty the applier goes to sleep, and the
+ * next submit wakes it up.
+ *
+ * While the applier runs it is the only thread that may use the TaskManager - stop it before reading from it.
+ */
+class TaskIngestionQueue {
+private:
+    struct Record {
+        string m_personName;
+        Task m_task;
+    };
+
+    TaskManager& m_manager;
+    mtm::MpscRing<Record> m_ring;
+    std::vector<Record> m_batch; // only used by the thread that drains
+
+    std::thread m_applier;
+    std::atomic<bool> m_stopping;
+
+    // the applier sleeps on m_wakeup once the queue stayed empty for a while, and only then do producers notify it
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeup;
+    std::atomic<bool> m_applierWaiting;
+
+    std::atomic<unsigned long long> m_submitted;
+    std::atomic<unsigned long long> m_dropped;
+    std::atomic<unsigned long long> m_backpressureWaits;
+    std::atomic<unsigned long long> m_applied;
+    std::atomic<unsigned long long> m_failed;
+
+    void applyUntilStopped();
+    void waitForRecords();
+    void wakeApplier();
+
+public:
+    /**
+     * @brief Number of records a default constructed queue can hold.
+     */
+    static const std::size_t DEFAULT_CAPACITY = 65536;
+
+    /**
+     * @brief Number of records drain applies at most by default.
+     */
+    static const std::size_t DEFAULT_BATCH_SIZE = 256;
+
+    /**
+     * @brief Constructor to create a queue in front of a TaskManager.
+     *
+     * @param manager The TaskManager the tasks are assigned in, it must outlive the queue.
+     * @param capacity The number of records the queue can hold, rounded up to a power of 2.
+     */
+    explicit TaskIngestionQueue(TaskManager& manager, std::size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Deleted copy constructor to prevent copying of TaskIngestionQueue objects.
+     */
+    TaskIngestionQueue(const TaskIngestionQueue& other) = delete;
+
+    /**
+     * @brief Deleted copy assignment operator to prevent assignment of TaskIngestionQueue objects.
+     */
+    TaskIngestionQueue& operator=(const TaskIngestionQueue& other) = delete;
+
+    /**
+     * @brief Destructor - stops the applier thread, after it applies everything that was submitted.
+     */
+    ~TaskIngestionQueue();
+
+    /**
+     * @brief Submits a task without waiting, from any thread.
+     *
+     * @param personName The name of the person to whom the task will be assigned.
+     * @param task The task to be assigned.
+     * @return true If the task was queued, false if the queue was full and the task was dropped.
+     */
+    bool trySubmit(const string& personName, const Task& task);
+
+    /**
+     * @brief Submits a task from any thread, waiting for room while the queue is full.
+     *
+     * @param personName The name of the person to whom the task will be assigned.
+     * @param task The task to be assigned.
+     */
+    void submit(const string& personName, const Task& task);
+
+    /**
+     * @brief Applies up to maxBatch of the oldest records to the TaskManager.
+     *
+     * Must only be called by one thread at a time, and not while the applier thread runs. A record the TaskManager
+     * can't assign, like one whose person can't be added, is counted as failed and skipped without taking an ID.
+     *
+     * @param maxBatch The maximum number of records to apply.
+     * @return std::size_t The number of records taken from the queue.
+     */
+    std::size_t drain(std::size_t maxBatch = DEFAULT_BATCH_SIZE);
+
+    /**
+     * @brief Starts a thread that keeps draining the queue until stopApplier is called.
+     */
+    void startApplier();
+
+    /**
+     * @brief Stops the applier thread, after it applies everything that was submitted before the call.
+     */
+    void stopApplier();
+
+    /**
+     * @brief The number of records waiting in the queue.
+     */
+    std::size_t depth() const;
+
+    /**
+     * @brief The number of tasks accepted into the queue.
+     */
+    unsigned long long submitted() const;
+
+    /**
+     * @brief The number of tasks trySubmit dropped because the queue was full.
+     */
+    unsigned long long dropped() const;
+
+    /**
+     * @brief The number of times submit found the queue full and had to wait.
+     */
+    unsigned long long backpressureWaits() const;
+
+    /**
+     * @brief The number of tasks assigned in the TaskManager.
+     */
+    unsigned long long applied() const;
+
+    /**
+     * @brief The number of tasks that couldn't be assigned, like ones whose person couldn't be added.
+     */
+    unsigned long long failed() const;
+};
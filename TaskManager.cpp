@@ -1,7 +1,21 @@
 
 #include "TaskManager.h"
 
-TaskManager::TaskManager() = default;
+TaskManager::TaskManager() : TaskManager(MAX_PERSONS) {}
+
+TaskManager::TaskManager(std::size_t maxPersons) : m_maxPersons(maxPersons) {
+    // tasks are added and completed one at a time, anywhere in the lists
+    m_allTasks.enableIndex();
+}
+
+PersonId TaskManager::registerPerson(const string &personName) {
+    const auto found = m_personsByName.find(personName);
+    if (found != m_personsByName.end()) {
+        return found->second;
+    }
+    addPerson(personName);
+    return static_cast<PersonId>(m_persons.size() - 1);
+}
 
 void TaskManager::assignTask(const string &personName, const Task &task) {
     Task newTask = task;
@@ -11,91 +25,284 @@ void TaskManager::assignTask(const string &personName, const Task &task) {
     if (curPerson == nullptr) { // if the person doesn't exist, add the person
         curPerson = addPerson(personName);
     }
-    curPerson->assignTask(newTask);
+    addTask(curPerson, std::move(newTask));
+}
+
+void TaskManager::assignTask(PersonId personId, const Task &task) {
+    Person* curPerson = personOf(personId);
+    Task newTask = task;
+    newTask.setId(m_newestTaskId++);
+    addTask(curPerson, std::move(newTask));
+}
+
+void TaskManager::assignTasks(const string &personName, const std::vector<Task> &tasks) {
+    Person* curPerson = findPerson(personName);
+    if (curPerson == nullptr) { // if the person doesn't exist, add the person
+        curPerson = addPerson(personName);
+    }
+
+    const TaskId firstId = m_newestTaskId;
+    try {
+        for (const Task& curTask : tasks) {
+            Task newTask = curTask;
+            newTask.setId(m_newestTaskId++);
+            addTask(curPerson, std::move(newTask));
+        }
+    }
+    catch (...) { // the tasks are assigned together or not at all
+        removeTasks(firstId, m_newestTaskId);
+        throw;
+    }
+}
+
+void TaskManager::assignTasks(const std::vector<std::pair<string, Task>> &tasks) {
+    // look up every person once, in the order they first appear
+    struct Group {
+        const string* m_personName;
+        Person* m_person;
+    };
+    std::vector<Group> groups;
+    std::vector<std::size_t> groupOfTask;
+    groupOfTask.reserve(tasks.size());
+    std::unordered_map<string, std::size_t> groupOfPerson;
+    std::size_t numOfNewPersons = 0;
+    for (const std::pair<string, Task>& curTask : tasks) {
+        const auto found = groupOfPerson.emplace(curTask.first, groups.size());
+        if (found.second) {
+            Person* curPerson = findPerson(curTask.first);
+            if (curPerson == nullptr) {
+                ++numOfNewPersons;
+            }
+            groups.push_back(Group{&curTask.first, curPerson});
+        }
+        groupOfTask.push_back(found.first->second);
+    }
+    if (numOfNewPersons > m_maxPersons - m_persons.size()) { // nothing is assigned if the persons don't fit
+        throw std::runtime_error("Max number of people reached");
+    }
+    for (Group& group : groups) {
+        if (group.m_person == nullptr) {
+            group.m_person = addPerson(*group.m_personName);
+        }
+    }
+
+    // the whole batch takes one range of IDs, in the order it was given
+    const TaskId firstId = m_newestTaskId;
+    try {
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            Task newTask = tasks[i].second;
+            newTask.setId(m_newestTaskId++);
+            addTask(groups[groupOfTask[i]].m_person, std::move(newTask));
+        }
+    }
+    catch (...) { // the batch is assigned together or not at all
+        removeTasks(firstId, m_newestTaskId);
+        throw;
+    }
 }
 
 void TaskManager::completeTask(const string &personName) {
     if (Person* curPerson = findPerson(personName)) { // if the person exists...
-        curPerson->completeTask();
+        removeTask(m_tasksById.find(curPerson->getHighestPriorityTask().getId()));
     }
 }
 
+void TaskManager::completeTask(PersonId personId) {
+    removeTask(m_tasksById.find(personOf(personId)->getHighestPriorityTask().getId()));
+}
+
+void TaskManager::completeTaskById(TaskId id) {
+    const auto location = m_tasksById.find(id);
+    if (location == m_tasksById.end()) {
+        throw std::runtime_error("Task not found");
+    }
+    removeTask(location);
+}
+
+bool TaskManager::cancelTask(TaskId id) {
+    const auto location = m_tasksById.find(id);
+    if (location == m_tasksById.end()) {
+        return false;
+    }
+    removeTask(location);
+    return true;
+}
+
+const Task& TaskManager::getTask(TaskId id) const {
+    const auto location = m_tasksById.find(id);
+    if (location == m_tasksById.end()) {
+        throw std::runtime_error("Task not found");
+    }
+    return *m_locations[location->second].m_inAllTasks;
+}
+
+const Person& TaskManager::getPerson(PersonId personId) const {
+    if (personId >= m_persons.size()) {
+        throw std::runtime_error("Person not found");
+    }
+    return m_persons[personId];
+}
+
 void TaskManager::bumpPriorityByType(TaskType type, int priority) {
     if (priority > 0) {
-        for (unsigned int i = 0; i < m_numOfPersons; ++i) {
-            Person& curPerson = m_personArray[i];
-            const SortedList<Task>& curTaskList = curPerson.getTasks();
-            SortedList<Task> newTaskList = curTaskList.apply([&type, &priority](const Task& curTask) -> Task {
-                if (curTask.getType() == type) {
-                    const int newPriority = curTask.getPriority() + priority;
-                    Task newTask(newPriority, curTask.getType(), curTask.getDescription());
-                    newTask.setId(curTask.getId());
-                    return newTask;
-                }
-                return curTask;
-            });
-            curPerson.setTasks(newTaskList);
+        TypeIndex& ofType = tasksOfType(type);
+        // only the tasks of this type are visited. a bumped task only moves towards the front of the index, ahead of
+        // the tasks still to be visited, and the ones already at the highest priority can't move and are skipped
+        for (TypeIndex::ConstIterator inType = ofType.begin(); inType != ofType.end();) {
+            const TypeIndex::ConstIterator curEntry = inType;
+            ++inType;
+            const Task& curTask = *(*curEntry).m_inAllTasks;
+            if (curTask.getPriority() == Task::MAX_PRIORITY) {
+                continue;
+            }
+            const std::size_t slot = m_tasksById.find(curTask.getId())->second;
+            const TaskLocation& location = m_locations[slot];
+            Task newTask(curTask.getPriority() + priority, curTask.getType(), curTask.getInternedDescription());
+            newTask.setId(curTask.getId());
+            location.m_owner->replaceTask(location.m_inPerson, newTask);
+            m_allTasks.replace(location.m_inAllTasks, std::move(newTask));
+            ofType.replace(curEntry, TypeEntry{TaskOrderKey()(curTask), location.m_inAllTasks});
         }
     }
 }
 
 void TaskManager::printAllEmployees() const {
-    for (unsigned int i = 0; i < m_numOfPersons; ++i) {
-        std::cout << m_personArray[i] << std::endl;
+    printAllEmployees(std::cout);
+}
+
+void TaskManager::printAllEmployees(ostream &os) const {
+    for (const Person& curPerson : m_persons) {
+        os << curPerson << '\n';
     }
+    os.flush();
 }
 
 void TaskManager::printTasksByType(TaskType type) const {
-    const SortedList<Task> listOfAllTasks = createListOfAllTasks();
-    const SortedList<Task> listToPrint = listOfAllTasks.filter([&type](const Task& curTask) -> bool {
-        if (curTask.getType() == type) {
-            return true;
-        }
-        return false;
-    });
-    printTaskList(listToPrint);
+    printTasksByType(type, std::cout);
+}
+
+void TaskManager::printTasksByType(TaskType type, ostream &os) const {
+    for (const TypeEntry& entry : tasksOfType(type)) {
+        os << *entry.m_inAllTasks << '\n';
+    }
+    os.flush();
 }
 
 void TaskManager::printAllTasks() const {
-    printTaskList(createListOfAllTasks());
+    printAllTasks(std::cout);
+}
+
+void TaskManager::printAllTasks(ostream &os) const {
+    printTaskList(m_allTasks, os);
 }
 
 // -------------------------------- helpers -------------------------------- //
 
 Person* TaskManager::findPerson(const string &personName) {
-    for (Person& curPerson : m_personArray) {
-        if (curPerson.getName() == personName) {
-            return &curPerson;
-        }
+    const auto found = m_personsByName.find(personName);
+    if (found == m_personsByName.end()) {
+        return nullptr;
     }
 
-    return nullptr;
+    return &m_persons[found->second];
 }
 
 Person *TaskManager::addPerson(const string &personName) {
-    if (m_numOfPersons >= MAX_PERSONS) {
+    if (m_persons.size() >= m_maxPersons) {
         throw std::runtime_error("Max number of people reached");
     }
-    m_personArray[m_numOfPersons++] = Person(personName);
+    m_persons.emplace_back(personName);
+    Person* newPerson = &m_persons.back();
+    try {
+        m_personsByName.emplace(personName, static_cast<PersonId>(m_persons.size() - 1));
+    }
+    catch (...) { // a person that can't be found by name is not added at all
+        m_persons.pop_back();
+        throw;
+    }
+
+    return newPerson;
+}
+
+Person *TaskManager::personOf(PersonId personId) {
+    if (personId >= m_persons.size()) {
+        throw std::runtime_error("Person not found");
+    }
+    return &m_persons[personId];
+}
+
+void TaskManager::swap(TaskManager &other) noexcept {
+    // the persons and the list nodes keep their addresses, so the locations stay valid on either side
+    std::swap(m_persons, other.m_persons);
+    std::swap(m_personsByName, other.m_personsByName);
+    std::swap(m_maxPersons, other.m_maxPersons);
+    std::swap(m_newestTaskId, other.m_newestTaskId);
+    std::swap(m_allTasks, other.m_allTasks);
+    std::swap(m_tasksByType, other.m_tasksByType);
+    std::swap(m_locations, other.m_locations);
+    std::swap(m_tasksById, other.m_tasksById);
+}
+
+void TaskManager::addTask(Person* owner, Task newTask) {
+    const TaskId id = newTask.getId();
+    const auto inAllTasks = m_allTasks.emplace(newTask);
+    TypeIndex& ofType = tasksOfType(newTask.getType());
+    TypeIndex::ConstIterator inType = ofType.end();
+    const std::size_t slot = m_locations.size();
+    Person::TaskQueue::ConstIterator inPerson = owner->getTasks().end();
+    try {
+        inType = ofType.emplace(TypeEntry{TaskOrderKey()(newTask), inAllTasks});
+        inPerson = owner->assignTask(std::move(newTask));
+        m_locations.push_back(TaskLocation{owner, inPerson, inAllTasks, inType});
+        m_tasksById.emplace(id, slot);
+    }
+    catch (...) { // keep the indexes in sync with the persons, removing end() does nothing
+        if (m_locations.size() > slot) {
+            m_locations.pop_back();
+        }
+        owner->removeTask(inPerson);
+        ofType.remove(inType);
+        m_allTasks.remove(inAllTasks);
+        throw;
+    }
+}
+
+void TaskManager::removeTask(IdIndex::iterator found) noexcept {
+    const std::size_t slot = found->second;
+    const TaskLocation& location = m_locations[slot];
+    tasksOfType((*location.m_inAllTasks).getType()).remove(location.m_inType);
+    m_allTasks.remove(location.m_inAllTasks);
+    location.m_owner->removeTask(location.m_inPerson);
+    m_tasksById.erase(found);
 
-    return &m_personArray[m_numOfPersons - 1];
+    // the task in the last slot moves into the freed one
+    m_locations[slot] = m_locations.back();
+    m_locations.pop_back();
+    if (slot < m_locations.size()) {
+        m_tasksById.find((*m_locations[slot].m_inAllTasks).getId())->second = slot;
+    }
 }
 
-SortedList<Task> TaskManager::createListOfAllTasks() const {
-    SortedList<Task> newListOfTasks;
-    for (unsigned int i = 0; i < m_numOfPersons; ++i) {
-        const Person& curPerson = m_personArray[i];
-        const SortedList<Task>& curTaskList = curPerson.getTasks();
-        for (const Task& curTask : curTaskList) {
-            newListOfTasks.insert(curTask);
+void TaskManager::removeTasks(TaskId first, TaskId last) noexcept {
+    for (TaskId id = first; id < last; ++id) {
+        const auto location = m_tasksById.find(id);
+        if (location != m_tasksById.end()) {
+            removeTask(location);
         }
     }
+}
+
+TaskManager::TypeIndex& TaskManager::tasksOfType(TaskType type) {
+    return m_tasksByType[static_cast<int>(type)];
+}
 
-    return newListOfTasks;
+const TaskManager::TypeIndex& TaskManager::tasksOfType(TaskType type) const {
+    return m_tasksByType[static_cast<int>(type)];
 }
 
-void TaskManager::printTaskList(const SortedList<Task> &listToPrint) {
+void TaskManager::printTaskList(const SortedList<Task> &listToPrint, ostream &os) {
     for (const Task& curTask : listToPrint) {
-        std::cout << curTask << std::endl;
+        os << curTask << '\n';
     }
+    os.flush();
 }
@@ -1,39 +1,126 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "Person.h"
 #include "SortedList.h"
+#include "BucketedSortedList.h"
 #include "Task.h"
 
+/**
+ * @brief Dense integer handle to a person in a TaskManager - the persons are numbered 0, 1, 2... in the order
+ * they were added.
+ */
+using PersonId = std::uint32_t;
+
 /**
  * @brief Class managing tasks assigned to multiple persons.
  */
 class TaskManager {
 private:
     /**
-     * @brief Maximum number of persons the TaskManager can handle.
+     * @brief Maximum number of persons a default constructed TaskManager can handle.
+     */
+    static const std::size_t MAX_PERSONS = 10;
+
+    // persons are kept in the order they were added, so the ID of a person is their place in the deque
+    std::deque<Person> m_persons;
+    std::unordered_map<string, PersonId> m_personsByName;
+    std::size_t m_maxPersons;
+    TaskId m_newestTaskId = 0;
+
+    // every live task of every person, kept in priority order so the global views are a single walk
+    SortedList<Task> m_allTasks;
+
+    /**
+     * @brief A task in the index of its type - its place in the order of tasks, and its node in m_allTasks.
      */
-    static const int MAX_PERSONS = 10;
-    Person m_personArray[MAX_PERSONS];
-    unsigned int m_numOfPersons = 0;
-    int m_newestTaskId = 0;
+    struct TypeEntry {
+        std::pair<int, std::uint64_t> m_order; // the TaskOrderKey of the task
+        SortedList<Task>::ConstIterator m_inAllTasks;
+    };
+
+    struct TypeEntryKey {
+        const std::pair<int, std::uint64_t>& operator()(const TypeEntry& entry) const {
+            return entry.m_order;
+        }
+    };
+
+    struct TypeEntryPriorityKey {
+        int operator()(const TypeEntry& entry) const {
+            return entry.m_order.first;
+        }
+    };
+
+    using TypeIndex = SortedList<TypeEntry, mtm::ByKey<TypeEntryKey>,
+                                 mtm::PriorityBuckets<TypeEntryPriorityKey, Task::MAX_PRIORITY>>;
+
+    static const int NUM_TASK_TYPES = static_cast<int>(TaskType::General) + 1;
+
+    // the tasks of every type in priority order, so type-scoped operations only visit the matching tasks
+    TypeIndex m_tasksByType[NUM_TASK_TYPES];
+
+    /**
+     * @brief Where a task is kept - its person and its node in every list, so it can be reached without a search.
+     */
+    struct TaskLocation {
+        Person* m_owner;
+        Person::TaskQueue::ConstIterator m_inPerson;
+        SortedList<Task>::ConstIterator m_inAllTasks;
+        TypeIndex::ConstIterator m_inType;
+    };
+
+    // the location of every live task, by slot - the slots stay dense, the last one moves into a freed one
+    std::vector<TaskLocation> m_locations;
+
+    using IdIndex = std::unordered_map<TaskId, std::size_t>;
+
+    // the slot of every live task by its ID
+    IdIndex m_tasksById;
+
+    void addTask(Person* owner, Task newTask);
+    void removeTask(IdIndex::iterator found) noexcept;
+    void removeTasks(TaskId first, TaskId last) noexcept;
+    TypeIndex& tasksOfType(TaskType type);
+    const TypeIndex& tasksOfType(TaskType type) const;
 
     // Note - Additional private fields and methods can be added if needed.
 
     Person *findPerson(const string &personName);
     Person *addPerson(const string &personName);
-    SortedList<Task> createListOfAllTasks() const;
+    Person *personOf(PersonId personId);
+    void swap(TaskManager &other) noexcept;
 
-    static void printTaskList(const SortedList<Task> &listToPrint);
+    static void printTaskList(const SortedList<Task> &listToPrint, ostream &os);
 
 public:
+    /**
+     * @brief Capacity that lets the TaskManager hold any number of persons.
+     */
+    static const std::size_t UNLIMITED_PERSONS = std::numeric_limits<std::size_t>::max();
+
     /**
      * @brief Default constructor to create a TaskManager object.
      *
-     * Note - you may add =default if needed.
+     * The TaskManager can handle up to 10 persons.
      */
     TaskManager();
 
+    /**
+     * @brief Constructor to create a TaskManager object that can handle a given number of persons.
+     *
+     * Persons are looked up by name in constant time, so the capacity can be as large as needed.
+     *
+     * @param maxPersons The maximum number of persons, or UNLIMITED_PERSONS for no limit.
+     */
+    explicit TaskManager(std::size_t maxPersons);
+
     /**
      * @brief Deleted copy constructor to prevent copying of TaskManager objects.
      */
@@ -44,6 +131,17 @@ public:
      */
     TaskManager &operator=(const TaskManager &other) = delete;
 
+    /**
+     * @brief Gets the ID of a person, adding the person if they don't exist yet.
+     *
+     * IDs are dense and never change, so callers can keep per-person state in arrays indexed by them.
+     *
+     * @param personName The name of the person.
+     * @return PersonId The ID of the person.
+     * @throw std::runtime_error If the person has to be added and the maximum number of persons is reached.
+     */
+    PersonId registerPerson(const string &personName);
+
     /**
      * @brief Assigns a task to a person.
      *
@@ -52,6 +150,38 @@ public:
      */
     void assignTask(const string &personName, const Task &task);
 
+    /**
+     * @brief Assigns a task to a person by their ID, without looking up their name.
+     *
+     * @param personId The ID of the person, as returned by registerPerson.
+     * @param task The task to be assigned.
+     * @throw std::runtime_error If there is no person with this ID.
+     */
+    void assignTask(PersonId personId, const Task &task);
+
+    /**
+     * @brief Assigns many tasks to a person at once.
+     *
+     * The tasks get consecutive IDs in the order they are given, exactly as if assignTask was called for each
+     * of them, but the person is looked up once. If one of the tasks can't be assigned, none of them are.
+     *
+     * @param personName The name of the person to whom the tasks will be assigned.
+     * @param tasks The tasks to be assigned.
+     */
+    void assignTasks(const string &personName, const std::vector<Task> &tasks);
+
+    /**
+     * @brief Assigns a batch of tasks, each to its own person.
+     *
+     * The tasks get consecutive IDs in the order they are given, exactly as if assignTask was called for each
+     * of them, but every person is looked up once. If the new persons in the batch don't fit in the TaskManager,
+     * or one of the tasks can't be assigned, no task is assigned.
+     *
+     * @param tasks Pairs of the name of a person and a task to be assigned to them.
+     * @throw std::runtime_error If adding the new persons would exceed the maximum number of persons.
+     */
+    void assignTasks(const std::vector<std::pair<string, Task>> &tasks);
+
     /**
      * @brief Completes the highest priority task assigned to a person.
      *
@@ -59,6 +189,48 @@ public:
      */
     void completeTask(const string &personName);
 
+    /**
+     * @brief Completes the highest priority task assigned to a person by their ID, without looking up their name.
+     *
+     * @param personId The ID of the person, as returned by registerPerson.
+     * @throw std::runtime_error If there is no person with this ID, or they have no tasks.
+     */
+    void completeTask(PersonId personId);
+
+    /**
+     * @brief Completes a specific task, whatever its priority, in constant average time.
+     *
+     * @param id The ID of the task to be completed.
+     * @throw std::runtime_error If no task with this ID is assigned.
+     */
+    void completeTaskById(TaskId id);
+
+    /**
+     * @brief Cancels a specific task, taking it away from its person, in constant average time.
+     *
+     * @param id The ID of the task to be cancelled.
+     * @return true If the task was cancelled, false if no task with this ID is assigned.
+     */
+    bool cancelTask(TaskId id);
+
+    /**
+     * @brief Gets a task by its ID, in constant average time.
+     *
+     * @param id The ID of the task.
+     * @return const Task& The task, valid until it is completed or cancelled.
+     * @throw std::runtime_error If no task with this ID is assigned.
+     */
+    const Task& getTask(TaskId id) const;
+
+    /**
+     * @brief Gets a person by their ID, in constant time.
+     *
+     * @param personId The ID of the person, as returned by registerPerson.
+     * @return const Person& The person, valid as long as the TaskManager.
+     * @throw std::runtime_error If there is no person with this ID.
+     */
+    const Person& getPerson(PersonId personId) const;
+
     /**
      * @brief Bumps the priority of all tasks of a specific type.
      *
@@ -71,6 +243,13 @@ public:
      */
     void printAllEmployees() const;
 
+    /**
+     * @brief Prints all employees and their tasks to the given stream, flushing it once at the end.
+     *
+     * @param os The output stream.
+     */
+    void printAllEmployees(ostream &os) const;
+
     /**
      * @brief Prints all tasks of a specific type.
      *
@@ -78,8 +257,49 @@ public:
      */
     void printTasksByType(TaskType type) const;
 
+    /**
+     * @brief Prints all tasks of a specific type to the given stream, flushing it once at the end.
+     *
+     * @param type The type of tasks to be printed.
+     * @param os The output stream.
+     */
+    void printTasksByType(TaskType type, ostream &os) const;
+
     /**
      * @brief Prints all tasks assigned to all employees.
      */
     void printAllTasks() const;
+
+    /**
+     * @brief Prints all tasks assigned to all employees to the given stream, flushing it once at the end.
+     *
+     * @param os The output stream.
+     */
+    void printAllTasks(ostream &os) const;
+
+    /**
+     * @brief Saves all persons and tasks to a snapshot file, replacing the file if it exists.
+     *
+     * The snapshot is a binary file in the byte order of this machine, with a version and a checksum. Its tasks are
+     * kept in priority order, so loading it doesn't sort anything. The file is written under a temporary name and
+     * renamed into place, so an existing snapshot is only replaced by a complete one.
+     *
+     * @param path The path of the snapshot file.
+     * @return std::uint64_t The checksum of the snapshot, which tells it apart from other snapshots.
+     * @throw std::runtime_error If the file can't be written.
+     */
+    std::uint64_t saveSnapshot(const string &path) const;
+
+    /**
+     * @brief Replaces all persons and tasks with the ones in a snapshot file, in time linear in its size.
+     *
+     * The file is mapped into memory where the system allows it, and read whole otherwise. Task IDs, person IDs and
+     * the maximum number of persons are the ones that were saved.
+     *
+     * @param path The path of the snapshot file.
+     * @return std::uint64_t The checksum of the snapshot, the one saveSnapshot returned when it was saved.
+     * @throw std::runtime_error If the file can't be read, isn't a snapshot of a supported version, or is corrupt -
+     *        in which case the TaskManager is left unchanged.
+     */
+    std::uint64_t loadSnapshot(const string &path);
 };
@@ -0,0 +1,324 @@
+#include "TaskManager.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SNAPSHOT_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Snapshot layout, in the byte order of the machine that wrote it:
+//   header
+//   person records       - the persons in the order they were added, so their place is their PersonId
+//   description records  - every distinct description once
+//   task records         - every task in priority order, which is also each person's own order
+//   text                 - the names and descriptions the records point into
+// The checksum covers the header up to the checksum itself and everything after the header.
+
+namespace {
+    const char SNAPSHOT_MAGIC[8] = {'M', 'T', 'M', 'S', 'N', 'A', 'P', '\0'};
+    const std::uint32_t SNAPSHOT_VERSION = 1;
+
+    struct SnapshotHeader {
+        char m_magic[8];
+        std::uint32_t m_version;
+        std::uint32_t m_headerSize;
+        std::uint64_t m_maxPersons;
+        std::int64_t m_newestTaskId;
+        std::uint64_t m_numOfPersons;
+        std::uint64_t m_numOfDescriptions;
+        std::uint64_t m_numOfTasks;
+        std::uint64_t m_textSize;
+        std::uint64_t m_checksum;
+    };
+
+    struct TextRecord { // a name or a description, as a range of the text
+        std::uint64_t m_offset;
+        std::uint64_t m_length;
+    };
+
+    struct TaskRecord {
+        std::int64_t m_id;
+        std::uint32_t m_person;
+        std::uint32_t m_description;
+        std::uint8_t m_priority;
+        std::uint8_t m_type;
+        std::uint8_t m_padding[6];
+    };
+
+    const std::size_t CHECKED_HEADER_SIZE = offsetof(SnapshotHeader, m_checksum);
+
+    // FNV-1a, continued from a previous hash
+    std::uint64_t checksum(const char* data, std::size_t size, std::uint64_t hash = 14695981039346656037ULL) {
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template <typename Record>
+    void append(std::vector<char>& buffer, const Record& record) {
+        const char* bytes = reinterpret_cast<const char*>(&record);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(Record));
+    }
+
+    template <typename Record>
+    Record recordAt(const char* data, std::size_t index) {
+        Record record;
+        std::memcpy(&record, data + index * sizeof(Record), sizeof(Record));
+        return record;
+    }
+
+    /**
+     * @brief A whole file in memory - mapped where the system can map files, read into a buffer elsewhere.
+     */
+    class SnapshotFile {
+        const char* m_data;
+        std::size_t m_size;
+#ifdef SNAPSHOT_MMAP
+        void* m_mapping;
+#endif
+        std::vector<char> m_buffer;
+
+    public:
+        explicit SnapshotFile(const string& path) : m_data(nullptr), m_size(0) {
+#ifdef SNAPSHOT_MMAP
+            m_mapping = nullptr;
+            const int file = ::open(path.c_str(), O_RDONLY);
+            if (file < 0) {
+                throw std::runtime_error("Can't open snapshot " + path);
+            }
+            struct stat status;
+            if (::fstat(file, &status) != 0) {
+                ::close(file);
+                throw std::runtime_error("Can't read snapshot " + path);
+            }
+            m_size = static_cast<std::size_t>(status.st_size);
+            if (m_size > 0) {
+                m_mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+            }
+            ::close(file);
+            if (m_mapping == MAP_FAILED) {
+                throw std::runtime_error("Can't map snapshot " + path);
+            }
+            m_data = static_cast<const char*>(m_mapping);
+#else
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("Can't open snapshot " + path);
+            }
+            m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+#endif
+        }
+
+        SnapshotFile(const SnapshotFile& other) = delete;
+
+        SnapshotFile& operator=(const SnapshotFile& other) = delete;
+
+        ~SnapshotFile() {
+#ifdef SNAPSHOT_MMAP
+            if (m_mapping != nullptr) {
+                ::munmap(m_mapping, m_size);
+            }
+#endif
+        }
+
+        const char* data() const {
+            return m_data;
+        }
+
+        std::size_t size() const {
+            return m_size;
+        }
+    };
+
+    void corrupt(const string& path) {
+        throw std::runtime_error("Snapshot " + path + " is corrupt");
+    }
+}
+
+std::uint64_t TaskManager::saveSnapshot(const string &path) const {
+    std::unordered_map<const Person*, std::uint32_t> personIds;
+    std::vector<char> records;
+    string text;
+    for (const Person& curPerson : m_persons) {
+        personIds.emplace(&curPerson, static_cast<std::uint32_t>(personIds.size()));
+        append(records, TextRecord{text.size(), curPerson.getName().size()});
+        text += curPerson.getName();
+    }
+
+    // interned descriptions are the same string exactly when they have the same text
+    std::unordered_map<const string*, std::uint32_t> descriptionIds;
+    for (const Task& curTask : m_allTasks) {
+        const string& description = curTask.getDescription();
+        if (descriptionIds.emplace(&description, static_cast<std::uint32_t>(descriptionIds.size())).second) {
+            append(records, TextRecord{text.size(), description.size()});
+            text += description;
+        }
+    }
+
+    for (const Task& curTask : m_allTasks) {
+        const Person* owner = m_locations[m_tasksById.find(curTask.getId())->second].m_owner;
+        TaskRecord record = {};
+        record.m_id = curTask.getId();
+        record.m_person = personIds.find(owner)->second;
+        record.m_description = descriptionIds.find(&curTask.getDescription())->second;
+        record.m_priority = static_cast<std::uint8_t>(curTask.getPriority());
+        record.m_type = static_cast<std::uint8_t>(curTask.getType());
+        append(records, record);
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.m_magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.m_version = SNAPSHOT_VERSION;
+    header.m_headerSize = sizeof(SnapshotHeader);
+    header.m_maxPersons = m_maxPersons;
+    header.m_newestTaskId = m_newestTaskId;
+    header.m_numOfPersons = m_persons.size();
+    header.m_numOfDescriptions = descriptionIds.size();
+    header.m_numOfTasks = m_tasksById.size();
+    header.m_textSize = text.size();
+    std::uint64_t hash = checksum(reinterpret_cast<const char*>(&header), CHECKED_HEADER_SIZE);
+    hash = checksum(records.data(), records.size(), hash);
+    header.m_checksum = checksum(text.data(), text.size(), hash);
+
+    // written next to the old snapshot, synced and renamed over it, so a crash never leaves half a snapshot
+    const string tempPath = path + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    bool written = file != nullptr
+                   && std::fwrite(&header, sizeof(header), 1, file) == 1
+                   && (records.empty() || std::fwrite(records.data(), 1, records.size(), file) == records.size())
+                   && std::fwrite(text.data(), 1, text.size(), file) == text.size()
+                   && std::fflush(file) == 0;
+#ifdef SNAPSHOT_MMAP
+    written = written && ::fsync(::fileno(file)) == 0;
+#endif
+    if (file != nullptr && std::fclose(file) != 0) {
+        written = false;
+    }
+    if (!written) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Can't write snapshot " + path);
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Can't write snapshot " + path);
+    }
+    return header.m_checksum;
+}
+
+std::uint64_t TaskManager::loadSnapshot(const string &path) {
+    const SnapshotFile file(path);
+    if (file.size() < sizeof(SnapshotHeader)) {
+        corrupt(path);
+    }
+    const SnapshotHeader header = recordAt<SnapshotHeader>(file.data(), 0);
+    if (std::memcmp(header.m_magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a snapshot");
+    }
+    if (header.m_version != SNAPSHOT_VERSION || header.m_headerSize != sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Snapshot " + path + " has an unsupported version");
+    }
+
+    // every count is checked against the size of the file before anything is read
+    const std::uint64_t available = file.size() - sizeof(SnapshotHeader);
+    const std::uint64_t numOfTexts = header.m_numOfPersons + header.m_numOfDescriptions;
+    if (header.m_numOfPersons > available / sizeof(TextRecord) || numOfTexts > available / sizeof(TextRecord)
+        || header.m_numOfTasks > available / sizeof(TaskRecord)
+        || numOfTexts * sizeof(TextRecord) + header.m_numOfTasks * sizeof(TaskRecord) + header.m_textSize
+               != available) {
+        corrupt(path);
+    }
+    const char* textRecords = file.data() + sizeof(SnapshotHeader);
+    const char* taskRecords = textRecords + numOfTexts * sizeof(TextRecord);
+    const char* text = taskRecords + header.m_numOfTasks * sizeof(TaskRecord);
+    const std::uint64_t hash = checksum(file.data(), CHECKED_HEADER_SIZE);
+    if (checksum(textRecords, available, hash) != header.m_checksum) {
+        corrupt(path);
+    }
+    const auto textOf = [&](std::uint64_t index) -> std::string_view {
+        const TextRecord record = recordAt<TextRecord>(textRecords, index);
+        if (record.m_offset > header.m_textSize || record.m_length > header.m_textSize - record.m_offset) {
+            corrupt(path);
+        }
+        return std::string_view(text + record.m_offset, record.m_length);
+    };
+
+    // everything is built in a new TaskManager and swapped in at the end, so a bad snapshot changes nothing
+    if (header.m_numOfPersons > header.m_maxPersons) {
+        corrupt(path);
+    }
+    TaskManager loaded(header.m_maxPersons);
+    loaded.m_newestTaskId = header.m_newestTaskId;
+    for (std::uint64_t i = 0; i < header.m_numOfPersons; ++i) {
+        const string personName(textOf(i));
+        if (loaded.findPerson(personName) != nullptr) {
+            corrupt(path);
+        }
+        loaded.addPerson(personName);
+    }
+    std::vector<InternedString> descriptions;
+    descriptions.reserve(header.m_numOfDescriptions);
+    for (std::uint64_t i = 0; i < header.m_numOfDescriptions; ++i) {
+        descriptions.emplace_back(textOf(header.m_numOfPersons + i));
+    }
+
+    std::vector<Task> tasks;
+    tasks.reserve(header.m_numOfTasks);
+    for (std::uint64_t i = 0; i < header.m_numOfTasks; ++i) {
+        const TaskRecord record = recordAt<TaskRecord>(taskRecords, i);
+        if (record.m_person >= header.m_numOfPersons || record.m_description >= header.m_numOfDescriptions
+            || record.m_priority > Task::MAX_PRIORITY || record.m_type > static_cast<int>(TaskType::General)
+            || record.m_id >= header.m_newestTaskId) {
+            corrupt(path);
+        }
+        tasks.emplace_back(record.m_priority, static_cast<TaskType>(record.m_type), descriptions[record.m_description]);
+        tasks.back().setId(record.m_id);
+        if (i > 0 && !std::greater<Task>()(tasks[i - 1], tasks[i])) { // out of order, or the same ID twice
+            corrupt(path);
+        }
+    }
+
+    // the tasks are already in order, so the list takes them in one pass and each person's list only appends
+    loaded.m_allTasks.insertRange(std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+    loaded.m_locations.reserve(tasks.size());
+    loaded.m_tasksById.reserve(tasks.size());
+    std::vector<TypeEntry> entriesOfType[NUM_TASK_TYPES];
+    std::vector<std::size_t> slotsOfType[NUM_TASK_TYPES];
+    auto inAllTasks = loaded.m_allTasks.begin();
+    for (std::uint64_t i = 0; i < header.m_numOfTasks; ++i, ++inAllTasks) {
+        const TaskRecord record = recordAt<TaskRecord>(taskRecords, i);
+        Person* owner = &loaded.m_persons[record.m_person];
+        const Task& curTask = *inAllTasks;
+        const int type = static_cast<int>(curTask.getType());
+        loaded.m_locations.push_back(TaskLocation{owner, owner->assignTask(curTask), inAllTasks,
+                                                  loaded.m_tasksByType[type].end()});
+        loaded.m_tasksById.emplace(curTask.getId(), i);
+        entriesOfType[type].push_back(TypeEntry{TaskOrderKey()(curTask), inAllTasks});
+        slotsOfType[type].push_back(i);
+    }
+
+    // the tasks of each type are in order as well, so every type index takes them in one pass too
+    for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+        TypeIndex& ofType = loaded.m_tasksByType[type];
+        ofType.insertRange(entriesOfType[type].begin(), entriesOfType[type].end());
+        auto inType = ofType.begin();
+        for (std::size_t slot : slotsOfType[type]) {
+            loaded.m_locations[slot].m_inType = inType;
+            ++inType;
+        }
+    }
+
+    swap(loaded);
+    return header.m_checksum;
+}
@@ -0,0 +1,619 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BucketedSortedList.h"
+#include "ChunkedSortedList.h"
+#include "ConcurrentTaskManager.h"
+#include "JournaledTaskManager.h"
+#include "SortedList.h"
+#include "TaskExecutor.h"
+#include "TaskIngestionQueue.h"
+#include "TaskManager.h"
+
+using std::cout;
+using std::endl;
+
+using mtm::SortedList;
+
+/**
+ * Benchmark suite for SortedList, TaskManager and the concurrent front ends built on them.
+ *
+ * Every measurement is printed as one JSON object per line:
+ *   {"benchmark": ..., "variant": ..., "distribution": ..., "n": ..., "ops": ..., "ns_per_op": ...,
+ *    "ops_per_sec": ..., "allocs_per_op": ...}
+ * so runs can be stored and compared between versions. Build with optimizations
+ * (-DCMAKE_BUILD_TYPE=Release) for meaningful numbers.
+ *
+ * Usage: HW3_2425B_bench [max n] [filter]
+ *   max n  - the largest scale to run, 10^2 up to it in powers of 10 (default 1000000)
+ *   filter - only run benchmarks whose name contains this string
+ */
+
+// ---------------------------- allocation counting ---------------------------- //
+
+// atomic, since the concurrent benchmarks allocate from many threads
+static std::atomic<unsigned long long> g_allocations(0);
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// ---------------------------------- harness ---------------------------------- //
+
+typedef std::chrono::steady_clock benchClock;
+
+namespace {
+
+    const char* g_filter = "";
+
+    // swallows everything the print methods write to std::cout
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override {
+            return c;
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize count) override {
+            return count;
+        }
+    };
+
+    bool selected(const char* benchmark) {
+        return std::strstr(benchmark, g_filter) != nullptr;
+    }
+
+    void report(const char* benchmark, const char* variant, const char* distribution, long long n, long long ops,
+                double totalNs, unsigned long long allocations) {
+        const double nsPerOp = totalNs / static_cast<double>(ops);
+        cout << "{\"benchmark\": \"" << benchmark << "\", \"variant\": \"" << variant
+             << "\", \"distribution\": \"" << distribution << "\", \"n\": " << n << ", \"ops\": " << ops
+             << ", \"ns_per_op\": " << nsPerOp << ", \"ops_per_sec\": " << 1e9 / nsPerOp
+             << ", \"allocs_per_op\": " << static_cast<double>(allocations) / static_cast<double>(ops) << "}"
+             << endl;
+    }
+
+    // runs body once and reports it as ops operations
+    void measure(const char* benchmark, const char* variant, const char* distribution, long long n, long long ops,
+                 const std::function<void()>& body) {
+        const unsigned long long allocationsBefore = g_allocations;
+        const benchClock::time_point start = benchClock::now();
+        body();
+        const double totalNs = std::chrono::duration<double, std::nano>(benchClock::now() - start).count();
+        report(benchmark, variant, distribution, n, ops, totalNs, g_allocations - allocationsBefore);
+    }
+
+    // ------------------------------- input data ------------------------------- //
+
+    class Random {
+        unsigned long long m_state;
+
+    public:
+        explicit Random(unsigned long long seed) : m_state(seed) {}
+
+        unsigned int next() {
+            m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<unsigned int>(m_state >> 33);
+        }
+    };
+
+    const TaskType ALL_TYPES[] = {TaskType::Meeting, TaskType::Presentation, TaskType::Documentation,
+                                  TaskType::Development, TaskType::Testing, TaskType::Research,
+                                  TaskType::Training, TaskType::Maintenance, TaskType::CustomerSupport,
+                                  TaskType::General};
+
+    const char* const DESCRIPTIONS[] = {"Run system tests", "Clean up code", "Weekly team meeting",
+                                        "Fix bug in UI", "Answer customer ticket"};
+
+    const char* const PERSON_NAMES[] = {"Alice", "Bob", "Charlie", "Dana", "Eve",
+                                        "Frank", "Grace", "Hank", "Ivy", "Judy"};
+
+    // uniform: every priority and type is as likely. skewed: mostly low priorities and common types,
+    // with CustomerSupport under 1% of the tasks
+    std::vector<Task> makeTasks(long long count, bool skewed, unsigned long long seed) {
+        Random random(seed);
+        std::vector<Task> tasks;
+        tasks.reserve(static_cast<std::size_t>(count));
+        for (long long i = 0; i < count; ++i) {
+            int priority;
+            TaskType type;
+            if (!skewed) {
+                priority = static_cast<int>(random.next() % 101);
+                type = ALL_TYPES[random.next() % 10];
+            }
+            else {
+                const unsigned int roll = random.next() % 1000;
+                priority = roll < 900 ? static_cast<int>(random.next() % 21) : static_cast<int>(random.next() % 101);
+                const unsigned int typeRoll = random.next() % 1000;
+                type = typeRoll < 500 ? TaskType::General
+                     : typeRoll < 800 ? TaskType::Development
+                     : typeRoll < 900 ? TaskType::Testing
+                     : typeRoll < 995 ? ALL_TYPES[random.next() % 8]
+                     : TaskType::CustomerSupport;
+            }
+            Task task(priority, type, DESCRIPTIONS[random.next() % 5]);
+            task.setId(static_cast<TaskId>(i));
+            tasks.push_back(task);
+        }
+        return tasks;
+    }
+
+    std::vector<int> makeInts(long long count, unsigned long long seed) {
+        Random random(seed);
+        std::vector<int> values;
+        values.reserve(static_cast<std::size_t>(count));
+        for (long long i = 0; i < count; ++i) {
+            values.push_back(static_cast<int>(random.next()));
+        }
+        return values;
+    }
+
+    // --------------------------- SortedList benchmarks --------------------------- //
+
+    typedef SortedList<int, std::greater<int>, std::allocator<int>> HeapNodeList;
+    typedef SortedList<int, std::greater<int>, mtm::ChunkedStorage<>> ChunkedList;
+
+    // plain (unindexed) inserts are quadratic, they only run up to these sizes
+    const long long PLAIN_INSERT_LIMIT = 10000;
+    const long long CHUNKED_INSERT_LIMIT = 100000;
+
+    template <typename List>
+    void benchListInsert(const char* variant, const std::vector<int>& values) {
+        const long long n = static_cast<long long>(values.size());
+        measure("SortedList/insert", variant, "uniform", n, n, [&values]() {
+            List list;
+            for (int value : values) {
+                list.insert(value);
+            }
+        });
+    }
+
+    void benchSortedList(long long n) {
+        const std::vector<int> values = makeInts(n, 12345);
+        const std::vector<Task> tasks = makeTasks(n, false, 12345);
+
+        if (selected("SortedList/insert")) {
+            if (n <= PLAIN_INSERT_LIMIT) {
+                benchListInsert<SortedList<int>>("plain", values);
+                benchListInsert<HeapNodeList>("plain-heap-nodes", values);
+            }
+            if (n <= CHUNKED_INSERT_LIMIT) {
+                benchListInsert<ChunkedList>("chunked", values);
+            }
+            measure("SortedList/insert", "indexed", "uniform", n, n, [&values]() {
+                SortedList<int> list;
+                list.enableIndex();
+                for (int value : values) {
+                    list.insert(value);
+                }
+            });
+            measure("SortedList/insert", "indexed-task", "uniform", n, n, [&tasks]() {
+                SortedList<Task> list;
+                list.enableIndex();
+                for (const Task& task : tasks) {
+                    list.insert(task);
+                }
+            });
+            measure("SortedList/insert", "buckets-task", "uniform", n, n, [&tasks]() {
+                Person::TaskQueue list;
+                for (const Task& task : tasks) {
+                    list.insert(task);
+                }
+            });
+            measure("SortedList/insert", "insertRange", "uniform", n, n, [&values]() {
+                SortedList<int> list(values.begin(), values.end());
+            });
+        }
+
+        SortedList<int> list(values.begin(), values.end());
+        list.enableIndex();
+
+        if (selected("SortedList/copy")) {
+            measure("SortedList/copy", "pooled-nodes", "uniform", n, n, [&list]() {
+                SortedList<int> copy(list);
+            });
+            const HeapNodeList heapList(values.begin(), values.end());
+            measure("SortedList/copy", "heap-nodes", "uniform", n, n, [&heapList]() {
+                HeapNodeList copy(heapList);
+            });
+            const ChunkedList chunked(values.begin(), values.end());
+            measure("SortedList/copy", "chunked", "uniform", n, n, [&chunked]() {
+                ChunkedList copy(chunked);
+            });
+        }
+
+        if (selected("SortedList/iterate")) {
+            long long sum = 0;
+            measure("SortedList/iterate", "linked", "uniform", n, n, [&list, &sum]() {
+                for (int value : list) {
+                    sum += value;
+                }
+            });
+            const ChunkedList chunked(values.begin(), values.end());
+            measure("SortedList/iterate", "chunked", "uniform", n, n, [&chunked, &sum]() {
+                for (int value : chunked) {
+                    sum += value;
+                }
+            });
+            if (sum == 42) { // keeps the loops from being optimized away
+                cout << "";
+            }
+        }
+
+        if (selected("SortedList/filter")) {
+            measure("SortedList/filter", "materialized", "uniform", n, n, [&list]() {
+                SortedList<int> evens = list.filter([](int x) { return x % 2 == 0; });
+            });
+            long long count = 0;
+            measure("SortedList/filter", "lazy-view", "uniform", n, n, [&list, &count]() {
+                for (int value : list.filtered([](int x) { return x % 2 == 0; })) {
+                    count += value & 1;
+                }
+            });
+        }
+
+        if (selected("SortedList/apply")) {
+            measure("SortedList/apply", "keeps-order", "uniform", n, n, [&list]() {
+                SortedList<int> halved = list.apply([](int x) { return x / 2; });
+            });
+            measure("SortedList/apply", "reorders", "uniform", n, n, [&list]() {
+                SortedList<int> negated = list.apply([](int x) { return -x; });
+            });
+            SortedList<int> target(list);
+            measure("SortedList/apply", "in-place-1%", "uniform", n, n, [&target]() {
+                target.applyInPlace([](int x) { return x % 100 == 0; }, [](int x) { return x + 1000; });
+            });
+        }
+
+        if (selected("SortedList/remove")) {
+            SortedList<int> popped(list);
+            measure("SortedList/remove", "front", "uniform", n, n, [&popped]() {
+                while (popped.length() > 0) {
+                    popped.remove(popped.begin());
+                }
+            });
+            SortedList<int> searched(list);
+            measure("SortedList/remove", "find-indexed", "uniform", n, n, [&searched, &values]() {
+                for (int value : values) {
+                    searched.remove(searched.find(value));
+                }
+            });
+        }
+    }
+
+    // --------------------------- TaskManager benchmarks --------------------------- //
+
+    void fill(TaskManager& manager, const std::vector<Task>& tasks) {
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            manager.assignTask(PERSON_NAMES[i % 10], tasks[i]);
+        }
+    }
+
+    void benchTaskManager(long long n, bool skewed) {
+        const char* distribution = skewed ? "skewed" : "uniform";
+        const std::vector<Task> tasks = makeTasks(n, skewed, 777);
+
+        if (selected("TaskManager/assignTask")) {
+            TaskManager manager;
+            measure("TaskManager/assignTask", "10-persons", distribution, n, n, [&manager, &tasks]() {
+                fill(manager, tasks);
+            });
+        }
+
+        if (selected("TaskManager/assignTask")) {
+            TaskManager manager;
+            std::vector<PersonId> personIds;
+            for (const char* personName : PERSON_NAMES) {
+                personIds.push_back(manager.registerPerson(personName));
+            }
+            measure("TaskManager/assignTask", "10-persons-by-id", distribution, n, n, [&manager, &tasks, &personIds]() {
+                for (std::size_t i = 0; i < tasks.size(); ++i) {
+                    manager.assignTask(personIds[i % 10], tasks[i]);
+                }
+            });
+        }
+
+        if (selected("TaskManager/assignTasks")) {
+            std::vector<std::pair<string, Task>> batch;
+            batch.reserve(tasks.size());
+            for (std::size_t i = 0; i < tasks.size(); ++i) {
+                batch.emplace_back(PERSON_NAMES[i % 10], tasks[i]);
+            }
+            TaskManager manager;
+            measure("TaskManager/assignTasks", "10-persons-batch", distribution, n, n, [&manager, &batch]() {
+                manager.assignTasks(batch);
+            });
+        }
+
+        if (selected("TaskManager/completeTask")) {
+            TaskManager manager;
+            fill(manager, tasks);
+            measure("TaskManager/completeTask", "10-persons", distribution, n, n, [&manager, n]() {
+                for (long long i = 0; i < n; ++i) {
+                    manager.completeTask(PERSON_NAMES[i % 10]);
+                }
+            });
+        }
+
+        if (selected("TaskManager/completeTaskById")) {
+            TaskManager manager;
+            fill(manager, tasks);
+            measure("TaskManager/completeTaskById", "newest-first", distribution, n, n, [&manager, n]() {
+                for (long long id = n - 1; id >= 0; --id) {
+                    manager.completeTaskById(id);
+                }
+            });
+        }
+
+        if (selected("TaskManager/bumpPriorityByType")) {
+            TaskManager manager;
+            fill(manager, tasks);
+            measure("TaskManager/bumpPriorityByType", "common-type", distribution, n, 1, [&manager]() {
+                manager.bumpPriorityByType(TaskType::General, 5);
+            });
+            measure("TaskManager/bumpPriorityByType", "rare-type", distribution, n, 1, [&manager]() {
+                manager.bumpPriorityByType(TaskType::CustomerSupport, 5);
+            });
+        }
+
+        if (selected("TaskManager/print")) {
+            TaskManager manager;
+            fill(manager, tasks);
+            NullBuffer nullBuffer;
+            std::streambuf* const coutBuffer = cout.rdbuf();
+            measure("TaskManager/printAllTasks", "10-persons", distribution, n, 1,
+                    [&manager, &nullBuffer, coutBuffer]() {
+                cout.rdbuf(&nullBuffer);
+                manager.printAllTasks();
+                cout.rdbuf(coutBuffer);
+            });
+            measure("TaskManager/printTasksByType", "rare-type", distribution, n, 1,
+                    [&manager, &nullBuffer, coutBuffer]() {
+                cout.rdbuf(&nullBuffer);
+                manager.printTasksByType(TaskType::CustomerSupport);
+                cout.rdbuf(coutBuffer);
+            });
+            std::ostream nullStream(&nullBuffer);
+            measure("TaskManager/printAllTasks", "10-persons-stream", distribution, n, 1, [&manager, &nullStream]() {
+                manager.printAllTasks(nullStream);
+            });
+        }
+
+        if (selected("TaskManager/snapshot")) {
+            TaskManager manager;
+            fill(manager, tasks);
+            const string path = "HW3_2425B_bench.snap";
+            measure("TaskManager/saveSnapshot", "10-persons", distribution, n, n, [&manager, &path]() {
+                manager.saveSnapshot(path);
+            });
+            TaskManager loaded;
+            measure("TaskManager/loadSnapshot", "10-persons", distribution, n, n, [&loaded, &path]() {
+                loaded.loadSnapshot(path);
+            });
+            std::remove(path.c_str());
+        }
+
+        if (selected("JournaledTaskManager/assignTask")) {
+            const string snapshotPath = "HW3_2425B_bench.snap";
+            const string journalPath = "HW3_2425B_bench.journal";
+            for (std::size_t groupSize : {std::size_t(1), std::size_t(64)}) {
+                if (groupSize == 1 && n > 1000) { // a sync per call is too slow for the larger sizes
+                    continue;
+                }
+                std::remove(snapshotPath.c_str());
+                std::remove(journalPath.c_str());
+                JournalOptions options;
+                options.m_groupSize = groupSize;
+                JournaledTaskManager manager(snapshotPath, journalPath, options);
+                const string variant = "group-of-" + std::to_string(groupSize);
+                measure("JournaledTaskManager/assignTask", variant.c_str(), distribution, n, n,
+                        [&manager, &tasks]() {
+                    for (std::size_t i = 0; i < tasks.size(); ++i) {
+                        manager.assignTask(PERSON_NAMES[i % 10], tasks[i]);
+                    }
+                    manager.commit();
+                });
+            }
+            std::remove(snapshotPath.c_str());
+            std::remove(journalPath.c_str());
+        }
+    }
+
+    // --------------------- ConcurrentTaskManager benchmarks --------------------- //
+
+    const int CONCURRENT_PERSONS = 1000;
+
+    // every thread assigns its share of the tasks to persons spread over all of them, completing one task for
+    // every two it assigns
+    template <typename Manager>
+    void runThreads(Manager& manager, const std::vector<Task>& tasks, const std::vector<string>& names,
+                    unsigned int numOfThreads) {
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < numOfThreads; ++t) {
+            threads.emplace_back([&manager, &tasks, &names, t, numOfThreads]() {
+                for (std::size_t i = t; i < tasks.size(); i += numOfThreads) {
+                    const string& name = names[i % names.size()];
+                    manager.assignTask(name, tasks[i]);
+                    if (i % 2 == 1) {
+                        try {
+                            manager.completeTask(name);
+                        }
+                        catch (const std::runtime_error&) { // another thread got there first
+                        }
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // the plain TaskManager behind one lock, the way it has to be shared without ConcurrentTaskManager
+    class LockedTaskManager {
+        std::mutex m_mutex;
+        TaskManager m_manager;
+
+    public:
+        LockedTaskManager() : m_manager(TaskManager::UNLIMITED_PERSONS) {}
+
+        void assignTask(const string& personName, const Task& task) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_manager.assignTask(personName, task);
+        }
+
+        void completeTask(const string& personName) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_manager.completeTask(personName);
+        }
+    };
+
+    // producers submit through a TaskIngestionQueue while its applier thread assigns, until everything is applied
+    void runProducers(TaskIngestionQueue& queue, const std::vector<Task>& tasks, const std::vector<string>& names,
+                      unsigned int numOfThreads) {
+        queue.startApplier();
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < numOfThreads; ++t) {
+            threads.emplace_back([&queue, &tasks, &names, t, numOfThreads]() {
+                for (std::size_t i = t; i < tasks.size(); i += numOfThreads) {
+                    queue.submit(names[i % names.size()], tasks[i]);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        queue.stopApplier();
+    }
+
+    void benchConcurrent(long long n) {
+        const bool runManagers = selected("ConcurrentTaskManager/assignAndComplete");
+        const bool runQueue = selected("TaskIngestionQueue/submit");
+        if (!runManagers && !runQueue) {
+            return;
+        }
+        const std::vector<Task> tasks = makeTasks(n, false, 4242);
+        std::vector<string> names;
+        for (int i = 0; i < CONCURRENT_PERSONS; ++i) {
+            names.push_back("Person" + std::to_string(i));
+        }
+
+        const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int numOfThreads = 1; numOfThreads <= hardwareThreads; numOfThreads *= 2) {
+            const string producersVariant = "applier-" + std::to_string(numOfThreads) + "-producers";
+            if (runQueue) {
+                measure("TaskIngestionQueue/submit", producersVariant.c_str(), "uniform", n, n,
+                        [&tasks, &names, numOfThreads]() {
+                    TaskManager manager(TaskManager::UNLIMITED_PERSONS);
+                    TaskIngestionQueue queue(manager);
+                    runProducers(queue, tasks, names, numOfThreads);
+                });
+            }
+            if (!runManagers) {
+                continue;
+            }
+            const string threadsSuffix = "-" + std::to_string(numOfThreads) + "-threads";
+            const string shardedVariant = "sharded" + threadsSuffix;
+            const string lockedVariant = "one-mutex" + threadsSuffix;
+            measure("ConcurrentTaskManager/assignAndComplete", shardedVariant.c_str(), "uniform", n, n,
+                    [&tasks, &names, numOfThreads]() {
+                ConcurrentTaskManager manager;
+                runThreads(manager, tasks, names, numOfThreads);
+            });
+            measure("ConcurrentTaskManager/assignAndComplete", lockedVariant.c_str(), "uniform", n, n,
+                    [&tasks, &names, numOfThreads]() {
+                LockedTaskManager manager;
+                runThreads(manager, tasks, names, numOfThreads);
+            });
+        }
+    }
+
+    void benchExecutor(long long n) {
+        if (!selected("TaskExecutor/run")) {
+            return;
+        }
+        // half of the tasks go to the first 10 of the persons, so the workers that were dealt them need help
+        const std::vector<Task> tasks = makeTasks(n, false, 99);
+
+        const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int numOfWorkers = 1; numOfWorkers <= hardwareThreads; numOfWorkers *= 2) {
+            TaskManager manager(TaskManager::UNLIMITED_PERSONS);
+            TaskExecutor executor(manager, numOfWorkers);
+            for (int i = 0; i < CONCURRENT_PERSONS; ++i) {
+                executor.addPerson(manager.registerPerson("Person" + std::to_string(i)));
+            }
+            for (std::size_t i = 0; i < tasks.size(); ++i) {
+                const std::size_t person = i % 2 == 0 ? i % 10 : i % CONCURRENT_PERSONS;
+                manager.assignTask(static_cast<PersonId>(person), tasks[i]);
+            }
+            std::atomic<unsigned long long> checksum(0);
+            const string variant = std::to_string(numOfWorkers) + "-workers";
+            measure("TaskExecutor/run", variant.c_str(), "uniform", n, n, [&executor, &checksum]() {
+                executor.run([&checksum](const string&, const Task& task) {
+                    unsigned long long work = static_cast<unsigned long long>(task.getId());
+                    for (int i = 0; i < 200; ++i) { // a little work per task
+                        work = work * 6364136223846793005ULL + 1;
+                    }
+                    checksum.fetch_add(work, std::memory_order_relaxed);
+                });
+            });
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    long long maxN = 1000000;
+    if (argc > 1) {
+        maxN = std::strtoll(argv[1], nullptr, 10);
+    }
+    if (argc > 2) {
+        g_filter = argv[2];
+    }
+
+    for (long long n = 100; n <= maxN; n *= 10) {
+        benchSortedList(n);
+        benchTaskManager(n, false);
+        benchTaskManager(n, true);
+        benchConcurrent(n);
+        benchExecutor(n);
+    }
+    return 0;
+}
@@ -1,5 +1,20 @@
 
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "BucketedSortedList.h"
+#include "ChunkedSortedList.h"
+#include "ConcurrentTaskManager.h"
+#include "JournaledTaskManager.h"
+#include "NodePool.h"
+#include "TaskExecutor.h"
+#include "TaskIngestionQueue.h"
 #include "TaskManager.h"
 #include "Task.h"
 
@@ -362,6 +377,842 @@ bool testCopyConstructorExceptionSafety()
 }
 
 
+int countedAllocations = 0;
+
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &) {}
+
+    T *allocate(std::size_t count)
+    {
+        ++countedAllocations;
+        return std::allocator<T>().allocate(count);
+    }
+    void deallocate(T *pointer, std::size_t count)
+    {
+        --countedAllocations;
+        std::allocator<T>().deallocate(pointer, count);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U> &) const { return false; }
+};
+
+bool testListAllocators()
+{
+    // the same operations through pooled nodes and plain heap nodes must give the same list
+    SortedList<int> pooled;
+    SortedList<int, std::greater<int>, std::allocator<int>> heap;
+    for (int i = 0; i < 200; ++i)
+    {
+        pooled.insert((i * 37) % 101);
+        heap.insert((i * 37) % 101);
+    }
+    // free half of the nodes and insert again, so freed nodes get reused
+    for (int i = 0; i < 100; ++i)
+    {
+        pooled.remove(pooled.begin());
+        heap.remove(heap.begin());
+    }
+    for (int i = 0; i < 50; ++i)
+    {
+        pooled.insert(i);
+        heap.insert(i);
+    }
+    ASSERT_TEST(pooled.length() == 150 && heap.length() == 150);
+
+    SortedList<int> pooledCopy(pooled);
+    auto heapIt = heap.begin();
+    for (int value : pooledCopy)
+    {
+        ASSERT_TEST(value == *heapIt);
+        ++heapIt;
+    }
+
+    // the index towers come from the list's allocator too
+    {
+        SortedList<int, std::greater<int>, CountingAllocator<int>> counted;
+        counted.enableIndex();
+        for (int i = 0; i < 100; ++i)
+        {
+            counted.insert(i);
+        }
+        ASSERT_TEST(countedAllocations > 100);
+        counted.disableIndex();
+        ASSERT_TEST(countedAllocations == 100);
+    }
+    ASSERT_TEST(countedAllocations == 0);
+
+    // a pool gets its memory when it is first used, so a new one costs nothing and only equals itself
+    ASSERT_TEST(std::is_nothrow_default_constructible<mtm::NodePool<int>>::value);
+    mtm::NodePool<int> unused;
+    ASSERT_TEST(unused == unused && unused != mtm::NodePool<int>());
+
+    // copies of a pool, also rebound ones, share its memory and can free each other's objects
+    mtm::NodePool<int> pool;
+    mtm::NodePool<int> poolCopy(pool);
+    mtm::NodePool<double> rebound(pool);
+    ASSERT_TEST(pool == poolCopy && pool == rebound && mtm::NodePool<int>(rebound) == pool);
+    int *fromPool = pool.allocate(1);
+    *fromPool = 7;
+    poolCopy.deallocate(fromPool, 1);
+    ASSERT_TEST(pool.allocate(1) == fromPool); // the freed slot is handed out again
+    double *fromRebound = rebound.allocate(1);
+    *fromRebound = 0.5;
+    mtm::NodePool<double>(poolCopy).deallocate(fromRebound, 1);
+    pool.deallocate(fromPool, 1);
+    ASSERT_TEST(pool != mtm::NodePool<int>());
+    ASSERT_TEST(std::allocator_traits<mtm::NodePool<int>>::select_on_container_copy_construction(pool) != pool);
+    return true;
+}
+
+bool testListIndex()
+{
+    // an indexed list must keep exactly the same order as a plain one, including equal elements
+    SortedList<int> plain;
+    SortedList<int> indexed;
+    indexed.enableIndex();
+    unsigned int seed = 12345;
+    for (int i = 0; i < 2000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        const int value = static_cast<int>((seed >> 16) % 500);
+        plain.insert(value);
+        indexed.insert(value);
+        if (i % 3 == 0)
+        {
+            auto it = indexed.find(value);
+            ASSERT_TEST(it != indexed.end() && *it == value);
+            indexed.remove(it);
+            plain.remove(plain.find(value));
+        }
+    }
+    ASSERT_TEST(!(indexed.find(-1) != indexed.end()));
+    ASSERT_TEST(plain.length() == indexed.length());
+    auto plainIt = plain.begin();
+    for (int value : indexed)
+    {
+        ASSERT_TEST(value == *plainIt);
+        ++plainIt;
+    }
+
+    // copies keep the index
+    SortedList<int> copy(indexed);
+    ASSERT_TEST(copy.isIndexed() && copy.length() == indexed.length());
+    copy.disableIndex();
+    copy.insert(250);
+    ASSERT_TEST(copy.find(250) != copy.end());
+    return true;
+}
+
+class CopyCountingType
+{
+public:
+    static int copies;
+
+    CopyCountingType(int value = 0) : value(value) {}
+    CopyCountingType(const CopyCountingType &other) : value(other.value) { ++copies; }
+    CopyCountingType(CopyCountingType &&other) noexcept : value(other.value) {}
+    CopyCountingType &operator=(const CopyCountingType &other)
+    {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    CopyCountingType &operator=(CopyCountingType &&other) noexcept
+    {
+        value = other.value;
+        return *this;
+    }
+
+    bool operator>(const CopyCountingType &other) const
+    {
+        return value > other.value;
+    }
+
+    int getValue() const
+    {
+        return value;
+    }
+
+private:
+    int value;
+};
+
+int CopyCountingType::copies = 0;
+
+bool testListMoveSemantics()
+{
+    CopyCountingType::copies = 0;
+    SortedList<CopyCountingType> list;
+    list.insert(CopyCountingType(3));
+    list.insert(CopyCountingType(1));
+    auto it = list.emplace(2);
+    ASSERT_TEST((*it).getValue() == 2);
+    ASSERT_TEST(CopyCountingType::copies == 0);
+
+    // moving a list hands over its nodes, nothing is copied
+    SortedList<CopyCountingType> moved(std::move(list));
+    ASSERT_TEST(moved.length() == 3 && list.length() == 0);
+    SortedList<CopyCountingType> assigned;
+    assigned.insert(CopyCountingType(7));
+    assigned = std::move(moved);
+    ASSERT_TEST(assigned.length() == 3 && moved.length() == 0);
+    ASSERT_TEST((*assigned.begin()).getValue() == 3);
+
+    // apply results are moved out instead of copied
+    SortedList<CopyCountingType> doubled = assigned.apply([](const CopyCountingType &x) {
+        return CopyCountingType(x.getValue() * 2);
+    });
+    ASSERT_TEST(doubled.length() == 3 && CopyCountingType::copies == 0);
+
+    // moved-from lists can be used again
+    list.insert(CopyCountingType(5));
+    ASSERT_TEST(list.length() == 1);
+    return true;
+}
+
+bool testListInsertRange()
+{
+    // a bulk insert must give the same list as inserting one by one
+    std::vector<int> batch;
+    unsigned int seed = 777;
+    for (int i = 0; i < 1000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        batch.push_back(static_cast<int>((seed >> 16) % 300));
+    }
+    SortedList<int> oneByOne;
+    SortedList<int> bulk;
+    bulk.enableIndex();
+    for (int i = 0; i < 100; i += 3)
+    {
+        oneByOne.insert(i);
+        bulk.insert(i);
+    }
+    for (int value : batch)
+    {
+        oneByOne.insert(value);
+    }
+    bulk.insertRange(batch.begin(), batch.end());
+    ASSERT_TEST(bulk.length() == oneByOne.length());
+    auto it = oneByOne.begin();
+    for (int value : bulk)
+    {
+        ASSERT_TEST(value == *it);
+        ++it;
+    }
+
+    SortedList<int> fromRange(batch.begin(), batch.end());
+    ASSERT_TEST(fromRange.length() == 1000);
+
+    // equal tasks keep their ID order, whatever order they come in
+    std::vector<Task> tasks = {Task(5, "e"), Task(3, "c"), Task(9, "d"), Task(3, "a"), Task(5, "b")};
+    const TaskId ids[] = {4, 2, 3, 0, 1};
+    for (int i = 0; i < 5; ++i)
+    {
+        tasks[i].setId(ids[i]);
+    }
+    SortedList<Task> taskList;
+    taskList.insert(tasks[0]);
+    taskList.insertRange(tasks.begin() + 1, tasks.end());
+    const TaskId expectedOrder[] = {3, 1, 4, 0, 2};
+    ASSERT_TEST(taskList.length() == 5);
+    auto taskIt = taskList.begin();
+    for (TaskId expectedId : expectedOrder)
+    {
+        if ((*taskIt).getId() != expectedId)
+            return false;
+        ++taskIt;
+    }
+
+    TaskManager manager;
+    manager.assignTasks("Alice", {Task(3, "a"), Task(5, "b"), Task(3, "c"), Task(9, "d")});
+    manager.assignTask("Alice", Task(5, "e"));
+    std::ostringstream os;
+    manager.printAllTasks(os);
+    ASSERT_TEST(os.str() == "Task ID: 3, Priority: 9, Type: General, Description: d\n"
+                            "Task ID: 1, Priority: 5, Type: General, Description: b\n"
+                            "Task ID: 4, Priority: 5, Type: General, Description: e\n"
+                            "Task ID: 0, Priority: 3, Type: General, Description: a\n"
+                            "Task ID: 2, Priority: 3, Type: General, Description: c\n");
+    return true;
+}
+
+struct Direction
+{
+    bool m_ascending;
+    bool operator()(int lhs, int rhs) const { return m_ascending ? lhs < rhs : lhs > rhs; }
+};
+
+bool testListViews()
+{
+    SortedList<int> list;
+    for (int i = 0; i < 20; ++i)
+    {
+        list.insert(i);
+    }
+
+    // a filtered view reads the list itself
+    auto evens = list.filtered([](int x) { return x % 2 == 0; });
+    int count = 0;
+    for (const int &x : evens)
+    {
+        ASSERT_TEST(x % 2 == 0);
+        ++count;
+    }
+    ASSERT_TEST(count == 10);
+    ASSERT_TEST(&(*evens.begin()) == &(*list.find(18)));
+    ASSERT_TEST(evens.toList().length() == 10);
+
+    // a transformed view computes on the fly, and its list is sorted even if the order changed
+    auto negated = list.transformed([](int x) { return -x; });
+    ASSERT_TEST(*negated.begin() == -19);
+    SortedList<int> negatedList = negated.toList();
+    ASSERT_TEST(*negatedList.begin() == 0 && negatedList.length() == 20);
+
+    // views follow the list they look at
+    list.insert(100);
+    ASSERT_TEST(*evens.begin() == 100);
+
+    // the list of a filtered view is ordered like its source, even by a comparator that has state
+    SortedList<int, Direction> ascending(Direction{true});
+    for (int i = 0; i < 20; ++i)
+    {
+        ascending.insert((i * 7) % 20);
+    }
+    const SortedList<int, Direction> ascendingEvens = ascending.filtered([](int x) { return x % 2 == 0; }).toList();
+    int expected = 0;
+    for (int x : ascendingEvens)
+    {
+        ASSERT_TEST(x == expected);
+        expected += 2;
+    }
+    ASSERT_TEST(expected == 20);
+
+    // or one that can't be default constructed at all
+    auto lastDigit = [](int x) { return x % 10; };
+    using ByLastDigit = mtm::ByKey<decltype(lastDigit)>;
+    SortedList<int, ByLastDigit> byDigit(ByLastDigit{lastDigit, std::greater<>()});
+    byDigit.insert(12).insert(39).insert(45).insert(7);
+    const SortedList<int, ByLastDigit> oddDigits = byDigit.filtered([](int x) { return x % 2 != 0; }).toList();
+    ASSERT_TEST(*oddDigits.begin() == 39 && oddDigits.length() == 3);
+
+    // a transformed view builds the list type it is asked for
+    const SortedList<int, Direction> negatedAscending =
+        list.transformed([](int x) { return -x; }).toList<SortedList<int, Direction>>(Direction{true});
+    ASSERT_TEST(*negatedAscending.begin() == -100 && negatedAscending.length() == 21);
+    const SortedList<int, std::less<int>> negatedLess = negated.toList<SortedList<int, std::less<int>>>();
+    ASSERT_TEST(*negatedLess.begin() == -100);
+    return true;
+}
+
+bool testListApplyInPlace()
+{
+    // in place updates must end the same as apply does
+    for (int size : {10, 1000})
+    {
+        SortedList<int> list;
+        list.enableIndex();
+        for (int i = 0; i < size; ++i)
+        {
+            list.insert((i * 7919) % size);
+        }
+        auto isMultipleOf = [](int divisor) {
+            return [divisor](int x) { return x % divisor == 0; };
+        };
+        auto bump = [](int x) { return x + 500; };
+        for (int divisor : {2, 97})
+        {
+            const SortedList<int> expected = list.apply([&](int x) {
+                return isMultipleOf(divisor)(x) ? bump(x) : x;
+            });
+            list.applyInPlace(isMultipleOf(divisor), bump);
+            ASSERT_TEST(list.length() == expected.length());
+            auto it = expected.begin();
+            for (int x : list)
+            {
+                ASSERT_TEST(x == *it);
+                ++it;
+            }
+            ASSERT_TEST(list.find(*expected.begin()) != list.end());
+        }
+    }
+    return true;
+}
+
+bool testListMerge()
+{
+    SortedList<int> first;
+    SortedList<int> second;
+    SortedList<int> third;
+    SortedList<int> expected;
+    for (int i = 0; i < 300; ++i)
+    {
+        SortedList<int> &target = i % 3 == 0 ? first : (i % 3 == 1 ? second : third);
+        target.insert((i * 31) % 50);
+        expected.insert((i * 31) % 50);
+    }
+    SortedList<int> empty;
+    SortedList<int> merged = SortedList<int>::merge({&first, &empty, &second, &third});
+    ASSERT_TEST(merged.length() == expected.length());
+    auto it = expected.begin();
+    for (int x : merged)
+    {
+        ASSERT_TEST(x == *it);
+        ++it;
+    }
+    ASSERT_TEST(SortedList<int>::merge({}).length() == 0);
+    return true;
+}
+
+bool testListChunkedStorage()
+{
+    // the chunked backend must behave exactly like the linked one
+    typedef SortedList<int, std::greater<int>, mtm::ChunkedStorage<1>> ChunkedList;
+    SortedList<int> linked;
+    ChunkedList chunked;
+    unsigned int seed = 4242;
+    for (int i = 0; i < 3000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        const int value = static_cast<int>((seed >> 16) % 400);
+        linked.insert(value);
+        chunked.insert(value);
+        if (i % 4 == 3)
+        {
+            // remove from somewhere in the middle
+            auto linkedIt = linked.begin();
+            auto chunkedIt = chunked.begin();
+            for (int step = 0; step < value % linked.length(); ++step)
+            {
+                ++linkedIt;
+                ++chunkedIt;
+            }
+            linked.remove(linkedIt);
+            chunked.remove(chunkedIt);
+        }
+    }
+    ASSERT_TEST(linked.length() == chunked.length());
+    auto it = linked.begin();
+    for (int value : chunked)
+    {
+        ASSERT_TEST(value == *it);
+        ++it;
+    }
+
+    ChunkedList copy(chunked);
+    ChunkedList odds = copy.filter([](int x) { return x % 2 != 0; });
+    ChunkedList negated = copy.apply([](int x) { return -x; });
+    ASSERT_TEST(copy.length() == chunked.length() && negated.length() == chunked.length());
+    ASSERT_TEST(*negated.begin() <= 0);
+    ASSERT_TEST(odds.length() == linked.filter([](int x) { return x % 2 != 0; }).length());
+
+    try
+    {
+        auto end = odds.end();
+        ++end;
+        return false;
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+    return true;
+}
+
+bool testListCompare()
+{
+    // tasks ordered through the default compare match operator>
+    SortedList<Task> byPriority;
+    SortedList<Task, mtm::ByKey<TaskIdKey, std::less<>>> byId;
+    for (int i = 0; i < 50; ++i)
+    {
+        Task task((i * 13) % 7, TaskType::Testing, "task");
+        task.setId((i * 17) % 50);
+        byPriority.insert(task);
+        byId.insert(task);
+    }
+    const Task *previous = nullptr;
+    for (const Task &task : byPriority)
+    {
+        ASSERT_TEST(previous == nullptr || *previous > task);
+        previous = &task;
+    }
+    int expectedId = 0;
+    for (const Task &task : byId)
+    {
+        ASSERT_TEST(task.getId() == expectedId++);
+    }
+
+    // any other order, for example ascending
+    SortedList<int, std::less<int>> ascending;
+    ascending.insert(3);
+    ascending.insert(1);
+    ascending.insert(2);
+    ASSERT_TEST(*ascending.begin() == 1);
+    return true;
+}
+bool testConcurrentTaskManager()
+{
+    ConcurrentTaskManager manager(8);
+    const int numOfThreads = 4;
+    const int tasksPerThread = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numOfThreads; ++t)
+    {
+        threads.emplace_back([&manager, t]() {
+            for (int i = 0; i < tasksPerThread; ++i)
+            {
+                manager.assignTask("Person" + std::to_string((t * tasksPerThread + i) % 16),
+                                   Task(i % 101, TaskType::Testing, "Run system tests"));
+                if (i % 100 == 0)
+                {
+                    manager.bumpPriorityByType(TaskType::Testing, 1);
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    // every task was assigned exactly once, so completing them all empties every person
+    int numOfCompleted = 0;
+    for (int person = 0; person < 16; ++person)
+    {
+        try
+        {
+            while (true)
+            {
+                manager.completeTask("Person" + std::to_string(person));
+                ++numOfCompleted;
+            }
+        }
+        catch (std::runtime_error &e)
+        {
+        }
+    }
+    ASSERT_TEST(numOfCompleted == numOfThreads * tasksPerThread);
+
+    ConcurrentTaskManager small(4, 2);
+    small.assignTask("Alice", Task(1, TaskType::General, "Clean up code"));
+    small.assignTask("Bob", Task(2, TaskType::Meeting, "Weekly team meeting"));
+    try
+    {
+        small.assignTask("Charlie", Task(3, TaskType::General, "Clean up code"));
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    small.printAllEmployees();
+    small.printAllTasks();
+    small.printTasksByType(TaskType::Meeting);
+    return true;
+}
+
+bool testTaskIngestionQueue()
+{
+    TaskManager manager(TaskManager::UNLIMITED_PERSONS);
+    TaskIngestionQueue queue(manager, 64);
+    queue.startApplier();
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t)
+    {
+        producers.emplace_back([&queue, t]() {
+            for (int i = 0; i < 1000; ++i)
+            {
+                queue.submit("Person" + std::to_string((t + i) % 8),
+                             Task(i % 101, TaskType::Testing, "Producer " + std::to_string(t) + " task " + std::to_string(i)));
+            }
+        });
+    }
+    for (std::thread &producer : producers)
+    {
+        producer.join();
+    }
+    queue.stopApplier();
+    ASSERT_TEST(queue.submitted() == 4000 && queue.applied() == 4000 && queue.depth() == 0);
+
+    // the tasks of every producer get their IDs in the order it submitted them
+    std::ostringstream allTasks;
+    manager.printAllTasks(allTasks);
+    std::istringstream lines(allTasks.str());
+    std::vector<std::vector<int>> idsOfProducer(4, std::vector<int>(1000, -1));
+    string line;
+    while (std::getline(lines, line))
+    {
+        int id = -1, producer = -1, index = -1;
+        ASSERT_TEST(std::sscanf(line.c_str(), "Task ID: %d, Priority: %*d, Type: Testing, Description: Producer %d task %d",
+                                &id, &producer, &index) == 3);
+        ASSERT_TEST(producer >= 0 && producer < 4 && index >= 0 && index < 1000);
+        ASSERT_TEST(idsOfProducer[producer][index] == -1);
+        idsOfProducer[producer][index] = id;
+    }
+    for (const std::vector<int> &ids : idsOfProducer)
+    {
+        ASSERT_TEST(ids[0] >= 0);
+        for (int i = 1; i < 1000; ++i)
+        {
+            ASSERT_TEST(ids[i] > ids[i - 1]);
+        }
+    }
+
+    int numOfCompleted = 0;
+    for (int person = 0; person < 8; ++person)
+    {
+        try
+        {
+            while (true)
+            {
+                manager.completeTask("Person" + std::to_string(person));
+                ++numOfCompleted;
+            }
+        }
+        catch (std::runtime_error &e)
+        {
+        }
+    }
+    ASSERT_TEST(numOfCompleted == 4000);
+
+    // an applier that fell asleep on an empty queue is woken up by the next submit
+    TaskManager quiet;
+    TaskIngestionQueue quietQueue(quiet);
+    quietQueue.startApplier();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    quietQueue.submit("Alice", Task(5, TaskType::General, "Clean up code"));
+    for (int i = 0; i < 1000 && quietQueue.applied() == 0; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TEST(quietQueue.applied() == 1);
+    quietQueue.stopApplier();
+
+    // a full queue drops, and the IDs follow the order of submission
+    TaskManager small;
+    TaskIngestionQueue smallQueue(small, 2);
+    ASSERT_TEST(smallQueue.trySubmit("Alice", Task(5, TaskType::General, "Clean up code")));
+    ASSERT_TEST(smallQueue.trySubmit("Bob", Task(5, TaskType::General, "Clean up code")));
+    ASSERT_TEST(!smallQueue.trySubmit("Alice", Task(5, TaskType::General, "Clean up code")));
+    ASSERT_TEST(smallQueue.dropped() == 1 && smallQueue.depth() == 2);
+    ASSERT_TEST(smallQueue.drain() == 2);
+    ASSERT_TEST(smallQueue.trySubmit("Alice", Task(7, TaskType::General, "Clean up code")));
+    ASSERT_TEST(smallQueue.trySubmit("Alice", Task(6, TaskType::General, "Clean up code")));
+    ASSERT_TEST(smallQueue.drain() == 2);
+    std::ostringstream employees;
+    small.printAllEmployees(employees);
+    ASSERT_TEST(employees.str() == "Person: Alice\n"
+                                   "Task ID: 2, Priority: 7, Type: General, Description: Clean up code\n"
+                                   "Task ID: 3, Priority: 6, Type: General, Description: Clean up code\n"
+                                   "Task ID: 0, Priority: 5, Type: General, Description: Clean up code\n"
+                                   "\n"
+                                   "Person: Bob\n"
+                                   "Task ID: 1, Priority: 5, Type: General, Description: Clean up code\n"
+                                   "\n");
+
+    // a record that fails takes no ID, whether it was applied alone or together with others
+    TaskManager onePerson(1);
+    TaskIngestionQueue onePersonQueue(onePerson);
+    const char *const names[] = {"Alice", "Bob", "Alice", "Bob", "Bob", "Alice"};
+    for (const char *name : names)
+    {
+        onePersonQueue.submit(name, Task(5, TaskType::General, "Clean up code"));
+    }
+    ASSERT_TEST(onePersonQueue.drain() == 6);
+    ASSERT_TEST(onePersonQueue.applied() == 3 && onePersonQueue.failed() == 3);
+    std::ostringstream onlyAlice;
+    onePerson.printAllTasks(onlyAlice);
+    ASSERT_TEST(onlyAlice.str() == "Task ID: 0, Priority: 5, Type: General, Description: Clean up code\n"
+                                   "Task ID: 1, Priority: 5, Type: General, Description: Clean up code\n"
+                                   "Task ID: 2, Priority: 5, Type: General, Description: Clean up code\n");
+    return true;
+}
+
+bool testTaskExecutor()
+{
+    // one busy person and a few idle ones, the other workers have to steal to help
+    TaskManager manager(TaskManager::UNLIMITED_PERSONS);
+    TaskExecutor executor(manager, 4);
+    for (int p = 0; p < 6; ++p)
+    {
+        const PersonId personId = manager.registerPerson("Person" + std::to_string(p));
+        const int numOfTasks = p == 0 ? 500 : 20;
+        for (int i = 0; i < numOfTasks; ++i)
+        {
+            manager.assignTask(personId, Task(i % 101, TaskType::Development, "Fix bug in UI"));
+        }
+        executor.addPerson(personId);
+    }
+
+    // Person0 got IDs 0 to 499, and every other person the next 20
+    std::mutex mutex;
+    std::vector<std::vector<int>> priorities(6);
+    bool namesMatch = true;
+    const unsigned long long numOfRun = executor.run([&](const string &personName, const Task &task) {
+        const int p = task.getId() < 500 ? 0 : 1 + (task.getId() - 500) / 20;
+        std::lock_guard<std::mutex> lock(mutex);
+        priorities[p].push_back(task.getPriority());
+        namesMatch = namesMatch && personName == "Person" + std::to_string(p);
+    });
+    ASSERT_TEST(numOfRun == 600 && namesMatch && executor.failed() == 0);
+    for (int p = 0; p < 6; ++p)
+    {
+        ASSERT_TEST(priorities[p].size() == (p == 0 ? 500u : 20u));
+        for (std::size_t i = 1; i < priorities[p].size(); ++i)
+        {
+            ASSERT_TEST(priorities[p][i - 1] >= priorities[p][i]); // each person's tasks in priority order
+        }
+    }
+    std::ostringstream left;
+    manager.printAllTasks(left);
+    ASSERT_TEST(left.str().empty()); // the tasks were completed in the TaskManager itself
+
+    // a task is only completed after its job succeeded, a failed one stays assigned
+    TaskManager small;
+    const PersonId alice = small.registerPerson("Alice");
+    small.assignTask(alice, Task(3, TaskType::General, "Clean up code"));
+    small.assignTask(alice, Task(2, TaskType::General, "Fix bug in UI"));
+    small.assignTask(alice, Task(1, TaskType::General, "Weekly team meeting"));
+    TaskExecutor failing(small, 2);
+    failing.addPerson(alice);
+    bool stillAssigned = true;
+    try
+    {
+        failing.run([&small, &stillAssigned](const string &, const Task &task) {
+            stillAssigned = stillAssigned && small.getTask(task.getId()).getId() == task.getId();
+            if (task.getPriority() == 2)
+            {
+                throw std::logic_error("job failed");
+            }
+        });
+        return false; // should have thrown exception
+    }
+    catch (std::logic_error &e)
+    {
+    }
+    ASSERT_TEST(stillAssigned && failing.failed() == 1);
+    std::ostringstream remaining;
+    small.printAllTasks(remaining);
+    ASSERT_TEST(remaining.str() == "Task ID: 1, Priority: 2, Type: General, Description: Fix bug in UI\n"
+                                   "Task ID: 2, Priority: 1, Type: General, Description: Weekly team meeting\n");
+
+    try
+    {
+        failing.addPerson(7);
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    return true;
+}
+
+
+struct IntTens
+{
+    int operator()(int value) const { return value / 10; }
+};
+
+struct IntThousands
+{
+    int operator()(int value) const { return value / 1000; }
+};
+
+struct CountingGreater
+{
+    int *m_comparisons;
+    bool operator()(int lhs, int rhs) const
+    {
+        ++*m_comparisons;
+        return lhs > rhs;
+    }
+};
+
+bool testListPriorityBuckets()
+{
+    typedef SortedList<int, std::greater<int>, mtm::PriorityBuckets<IntTens, 9>> BucketList;
+    BucketList list;
+    list.insert(42).insert(7).insert(95).insert(45).insert(41).insert(0);
+    const int expected[] = {95, 45, 42, 41, 7, 0};
+    int i = 0;
+    for (int value : list)
+    {
+        ASSERT_TEST(value == expected[i++]);
+    }
+    ASSERT_TEST(list.length() == 6);
+
+    list.remove(list.begin());
+    list.remove(list.find(7));
+    ASSERT_TEST(*list.begin() == 45);
+    ASSERT_TEST(!(list.find(7) != list.end()));
+    list.replace(list.find(0), 99);
+    ASSERT_TEST(*list.begin() == 99);
+    list.applyInPlace([](int value) { return value > 40 && value < 50; }, [](int value) { return value - 40; });
+    const int updated[] = {99, 5, 2, 1};
+    i = 0;
+    for (int value : list)
+    {
+        ASSERT_TEST(value == updated[i++]);
+    }
+
+    BucketList copy(list);
+    BucketList moved(std::move(list));
+    ASSERT_TEST(copy.length() == 4 && moved.length() == 4 && list.length() == 0);
+    try
+    {
+        moved.insert(100); // key 10 has no bucket
+        return false;
+    }
+    catch (std::out_of_range &e)
+    {
+    }
+    ASSERT_TEST(moved.length() == 4);
+
+    // tasks of equal priority stay in ID order
+    Person person("Alice");
+    for (int id = 0; id < 5; ++id)
+    {
+        Task task(id % 2 == 0 ? 10 : 20, TaskType::General, "Clean up code");
+        task.setId(id);
+        person.assignTask(task);
+    }
+    const int ids[] = {1, 3, 0, 2, 4};
+    i = 0;
+    for (const Task &task : person.getTasks())
+    {
+        ASSERT_TEST(task.getId() == ids[i++]);
+    }
+    ASSERT_TEST(person.completeTask() == 1 && person.getHighestPriorityTask().getId() == 3);
+
+    // an element that goes at either end of its bucket is linked without walking the bucket
+    int comparisons = 0;
+    typedef SortedList<int, CountingGreater, mtm::PriorityBuckets<IntThousands, 0>> OneBucketList;
+    OneBucketList oneBucket(CountingGreater{&comparisons});
+    for (int value = 0; value < 1000; ++value)
+    {
+        oneBucket.insert(value % 2 == 0 ? value : -value);
+    }
+    ASSERT_TEST(comparisons <= 3 * 1000);
+    oneBucket.replace(oneBucket.find(998), 500);
+    oneBucket.replace(oneBucket.find(-999), -1);
+    int previous = *oneBucket.begin();
+    for (int value : oneBucket)
+    {
+        ASSERT_TEST(value <= previous);
+        previous = value;
+    }
+    ASSERT_TEST(*oneBucket.begin() == 996 && oneBucket.length() == 1000);
+    return true;
+}
+
 
 bool testTaskManager()
 {
@@ -456,6 +1307,520 @@ bool testTaskManagerAssignTask()
     return true;
 }
 
+bool testTaskManagerManyPersons()
+{
+    TaskManager manager(TaskManager::UNLIMITED_PERSONS);
+    for (int i = 0; i < 1000; ++i)
+    {
+        manager.assignTask("Person" + std::to_string(i), Task(i % 101, TaskType::General, "Clean up code"));
+    }
+    manager.assignTask("Person7", Task(100, TaskType::Testing, "Run system tests"));
+    manager.assignTask("Person999", Task(0, TaskType::Testing, "Run system tests"));
+    manager.completeTask("Person7");
+    manager.completeTask("Nobody");
+
+    // every name finds its own person, and they are printed in the order they were added
+    std::ostringstream expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        expected << "Person: Person" << i << "\n"
+                 << "Task ID: " << i << ", Priority: " << i % 101 << ", Type: General, Description: Clean up code\n";
+        if (i == 999)
+        {
+            expected << "Task ID: 1001, Priority: 0, Type: Testing, Description: Run system tests\n";
+        }
+        expected << "\n";
+    }
+    std::ostringstream employees;
+    manager.printAllEmployees(employees);
+    ASSERT_TEST(employees.str() == expected.str());
+
+    TaskManager small(2);
+    small.assignTask("Alice", Task(1, TaskType::General, "Clean up code"));
+    small.assignTask("Bob", Task(2, TaskType::General, "Clean up code"));
+    small.assignTask("Alice", Task(3, TaskType::General, "Clean up code"));
+    try
+    {
+        small.assignTask("Charlie", Task(4, TaskType::General, "Clean up code"));
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    std::ostringstream smallEmployees;
+    small.printAllEmployees(smallEmployees);
+    ASSERT_TEST(smallEmployees.str() == "Person: Alice\n"
+                                        "Task ID: 2, Priority: 3, Type: General, Description: Clean up code\n"
+                                        "Task ID: 0, Priority: 1, Type: General, Description: Clean up code\n"
+                                        "\n"
+                                        "Person: Bob\n"
+                                        "Task ID: 1, Priority: 2, Type: General, Description: Clean up code\n"
+                                        "\n");
+    return true;
+}
+
+static string printedState(const TaskManager &manager)
+{
+    std::ostringstream output;
+    manager.printAllEmployees(output);
+    manager.printAllTasks(output);
+    return output.str();
+}
+
+bool testTaskManagerAssignBatch()
+{
+    TaskManager manager(3);
+    manager.assignTask("Alice", Task(5, TaskType::General, "Clean up code"));
+    std::vector<std::pair<string, Task>> batch;
+    batch.emplace_back("Bob", Task(7, TaskType::Testing, "Run system tests"));
+    batch.emplace_back("Alice", Task(9, TaskType::Development, "Fix bug in UI"));
+    batch.emplace_back("Bob", Task(7, TaskType::Testing, "Run system tests"));
+    batch.emplace_back("Charlie", Task(1, TaskType::Meeting, "Weekly team meeting"));
+    manager.assignTasks(batch);
+
+    // Dana doesn't fit, so Alice doesn't get her task either
+    std::vector<std::pair<string, Task>> tooMany;
+    tooMany.emplace_back("Alice", Task(100, TaskType::General, "Clean up code"));
+    tooMany.emplace_back("Dana", Task(1, TaskType::General, "Clean up code"));
+    const string before = printedState(manager);
+    try
+    {
+        manager.assignTasks(tooMany);
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    ASSERT_TEST(printedState(manager) == before);
+
+    // no ID was used up by the batch that was refused
+    manager.assignTask("Charlie", Task(2, TaskType::Meeting, "Weekly team meeting"));
+    std::ostringstream employees;
+    manager.printAllEmployees(employees);
+    ASSERT_TEST(employees.str() == "Person: Alice\n"
+                                   "Task ID: 2, Priority: 9, Type: Development, Description: Fix bug in UI\n"
+                                   "Task ID: 0, Priority: 5, Type: General, Description: Clean up code\n"
+                                   "\n"
+                                   "Person: Bob\n"
+                                   "Task ID: 1, Priority: 7, Type: Testing, Description: Run system tests\n"
+                                   "Task ID: 3, Priority: 7, Type: Testing, Description: Run system tests\n"
+                                   "\n"
+                                   "Person: Charlie\n"
+                                   "Task ID: 5, Priority: 2, Type: Meeting, Description: Weekly team meeting\n"
+                                   "Task ID: 4, Priority: 1, Type: Meeting, Description: Weekly team meeting\n"
+                                   "\n");
+    return true;
+}
+
+bool testTaskManagerPrintToStream()
+{
+    TaskManager manager;
+    manager.assignTask("Alice", Task(5, TaskType::CustomerSupport, "Answer calls"));
+    manager.assignTask("Bob", Task(9, TaskType::Testing, "Run system tests"));
+
+    std::ostringstream os;
+    manager.printAllTasks(os);
+    const string expected = "Task ID: 1, Priority: 9, Type: Testing, Description: Run system tests\n"
+                            "Task ID: 0, Priority: 5, Type: Customer Support, Description: Answer calls\n";
+    ASSERT_TEST(os.str() == expected);
+
+    const Task task(5, TaskType::CustomerSupport, "Answer calls");
+    char buffer[80];
+    const std::size_t length = task.format(buffer, sizeof(buffer));
+    ASSERT_TEST(string(buffer, length) == "Task ID: 0, Priority: 5, Type: Customer Support, Description: Answer calls");
+    ASSERT_TEST(task.format(buffer, length - 1) == length);
+    ASSERT_TEST(taskTypeName(TaskType::General) == "General");
+    return true;
+}
+
+bool testTaskManagerTaskById()
+{
+    TaskManager manager;
+    manager.assignTask("Alice", Task(5, TaskType::General, "Clean up code"));
+    manager.assignTask("Bob", Task(9, TaskType::Testing, "Run system tests"));
+    manager.assignTask("Alice", Task(7, TaskType::Testing, "Integration testing"));
+    manager.assignTask("Bob", Task(1, TaskType::Meeting, "Weekly team meeting"));
+
+    ASSERT_TEST(manager.getTask(2).getDescription() == "Integration testing");
+    manager.completeTaskById(2); // not Alice's first task by priority
+    ASSERT_TEST(manager.cancelTask(3));
+    ASSERT_TEST(!manager.cancelTask(3));
+    try
+    {
+        manager.completeTaskById(2);
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+
+    // a bumped task is still found by its ID, and completing by name still finds the right task
+    manager.bumpPriorityByType(TaskType::General, 10);
+    ASSERT_TEST(manager.getTask(0).getPriority() == 15);
+    manager.completeTask("Bob");
+    manager.assignTask("Bob", Task(3, TaskType::Research, "Explore new tech"));
+    ASSERT_TEST(manager.getTask(4).getId() == 4);
+    manager.printAllEmployees();
+    manager.printTasksByType(TaskType::Testing);
+    return true;
+}
+
+bool testInternedDescriptions()
+{
+    const std::size_t poolSizeBefore = InternedString::poolSize();
+    {
+        const Task first(5, TaskType::Testing, "Run interned system tests");
+        const Task second(7, TaskType::Testing, "Run interned system tests");
+        ASSERT_TEST(&first.getDescription() == &second.getDescription());
+        ASSERT_TEST(first.getInternedDescription() == second.getInternedDescription());
+        ASSERT_TEST(InternedString::poolSize() == poolSizeBefore + 1);
+
+        // a bumped task keeps sharing its description
+        TaskManager manager;
+        manager.assignTask("Alice", first);
+        manager.bumpPriorityByType(TaskType::Testing, 1);
+        ASSERT_TEST(&manager.getTask(0).getDescription() == &second.getDescription());
+
+        // handles are shared and dropped from many threads at once
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&first]() {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    const Task copy = first;
+                    const Task same(1, TaskType::General, "Run interned system tests");
+                    const Task other(1, TaskType::General, "Write interned docs " + std::to_string(i % 10));
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        ASSERT_TEST(InternedString::poolSize() == poolSizeBefore + 1);
+    }
+    ASSERT_TEST(InternedString::poolSize() == poolSizeBefore);
+    ASSERT_TEST(Task(1, TaskType::General).getDescription().empty());
+    return true;
+}
+
+bool testTaskManagerPersonIds()
+{
+    TaskManager manager(2);
+    const PersonId alice = manager.registerPerson("Alice");
+    manager.assignTask("Bob", Task(5, TaskType::General, "Clean up code"));
+    const PersonId bob = manager.registerPerson("Bob");
+    ASSERT_TEST(alice == 0 && bob == 1 && manager.registerPerson("Alice") == alice);
+
+    manager.assignTask(alice, Task(9, TaskType::Development, "Fix bug in UI"));
+    manager.assignTask(alice, Task(3, TaskType::Testing, "Run system tests"));
+    manager.assignTask(bob, Task(7, TaskType::Meeting, "Weekly team meeting"));
+    manager.completeTask(alice);
+    manager.completeTask("Bob");
+    try
+    {
+        manager.assignTask(PersonId(2), Task(1, TaskType::General));
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    try
+    {
+        manager.registerPerson("Charlie");
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    manager.printAllEmployees();
+    return true;
+}
+
+bool testTaskManagerSnapshot()
+{
+    const string path = "testTaskManagerSnapshot.snap";
+    TaskManager saved(3);
+    saved.assignTask("Alice", Task(9, TaskType::Development, "Fix bug in UI"));
+    saved.assignTask("Bob", Task(7, TaskType::Meeting, "Weekly team meeting"));
+    saved.assignTask("Alice", Task(9, TaskType::Testing, "Run system tests"));
+    saved.assignTask("Bob", Task(3, TaskType::Testing, "Run system tests"));
+    saved.registerPerson("Charlie");
+    saved.completeTaskById(1);
+    saved.saveSnapshot(path);
+
+    TaskManager loaded;
+    loaded.assignTask("Dave", Task(1, TaskType::General, "Replaced by the snapshot"));
+    loaded.loadSnapshot(path);
+    std::ostringstream savedOutput, loadedOutput;
+    saved.printAllEmployees(savedOutput);
+    saved.printAllTasks(savedOutput);
+    saved.printTasksByType(TaskType::Testing, savedOutput);
+    loaded.printAllEmployees(loadedOutput);
+    loaded.printAllTasks(loadedOutput);
+    loaded.printTasksByType(TaskType::Testing, loadedOutput);
+    ASSERT_TEST(savedOutput.str() == loadedOutput.str());
+    ASSERT_TEST(&loaded.getTask(2).getDescription() == &saved.getTask(3).getDescription());
+
+    // IDs and limits carry on from where the saved manager stopped
+    ASSERT_TEST(loaded.registerPerson("Charlie") == 2);
+    loaded.assignTask("Charlie", Task(5, TaskType::General, "Clean up code"));
+    ASSERT_TEST(loaded.getTask(4).getDescription() == "Clean up code");
+    loaded.completeTask("Alice");
+    loaded.bumpPriorityByType(TaskType::Testing, 10);
+    try
+    {
+        loaded.registerPerson("Dave");
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+
+    // a damaged snapshot is refused and leaves the manager as it was
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-3, std::ios::end);
+        file.put('?');
+    }
+    std::ostringstream before, after;
+    loaded.printAllTasks(before);
+    try
+    {
+        loaded.loadSnapshot(path);
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    loaded.printAllTasks(after);
+    ASSERT_TEST(before.str() == after.str());
+    std::remove(path.c_str());
+    try
+    {
+        loaded.loadSnapshot(path);
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    return true;
+}
+
+bool testJournaledTaskManager()
+{
+    const string snapshotPath = "testJournaledTaskManager.snap";
+    const string journalPath = "testJournaledTaskManager.journal";
+    std::remove(snapshotPath.c_str());
+    std::remove(journalPath.c_str());
+    JournalOptions options;
+    options.m_groupSize = 4;
+
+    // the same calls on a plain TaskManager give the state the journal has to rebuild
+    TaskManager expected(2);
+    {
+        JournaledTaskManager journaled(snapshotPath, journalPath, options, 2);
+        journaled.assignTask("Alice", Task(9, TaskType::Development, "Fix bug in UI"));
+        expected.assignTask("Alice", Task(9, TaskType::Development, "Fix bug in UI"));
+        journaled.assignTask("Bob", Task(7, TaskType::Meeting, "Weekly team meeting"));
+        expected.assignTask("Bob", Task(7, TaskType::Meeting, "Weekly team meeting"));
+        for (int i = 0; i < 2; ++i)
+        {
+            try
+            {
+                // the maximum number of persons is reached, but the call still uses up an ID
+                i == 0 ? journaled.assignTask("Charlie", Task(5, TaskType::General))
+                       : expected.assignTask("Charlie", Task(5, TaskType::General));
+                return false; // should have thrown exception
+            }
+            catch (std::runtime_error &e)
+            {
+            }
+        }
+        journaled.assignTasks("Bob", {Task(3, TaskType::Testing, "Run system tests"), Task(8, TaskType::Testing)});
+        expected.assignTasks("Bob", {Task(3, TaskType::Testing, "Run system tests"), Task(8, TaskType::Testing)});
+        ASSERT_TEST(journaled.cancelTask(1) && expected.cancelTask(1) && !journaled.cancelTask(1));
+        expected.cancelTask(1);
+        journaled.bumpPriorityByType(TaskType::Testing, 90);
+        expected.bumpPriorityByType(TaskType::Testing, 90);
+        journaled.completeTask(journaled.registerPerson("Alice"));
+        expected.completeTask(expected.registerPerson("Alice"));
+        ASSERT_TEST(printedState(journaled.manager()) == printedState(expected));
+    }
+    {
+        JournaledTaskManager reopened(snapshotPath, journalPath, options);
+        ASSERT_TEST(printedState(reopened.manager()) == printedState(expected));
+        ASSERT_TEST(reopened.manager().getTask(4).getPriority() == 98);
+
+        // after compaction, the snapshot holds the state and the journal only what came later
+        reopened.compact();
+        reopened.assignTask("Alice", Task(1, TaskType::Research, "Explore new tech"));
+        expected.assignTask("Alice", Task(1, TaskType::Research, "Explore new tech"));
+        reopened.commit();
+    }
+    {
+        std::ofstream journal(journalPath, std::ios::binary | std::ios::app);
+        journal << "torn"; // a record cut off by a crash
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        JournaledTaskManager reopened(snapshotPath, journalPath, options);
+        ASSERT_TEST(printedState(reopened.manager()) == printedState(expected));
+        ASSERT_TEST(reopened.manager().getTask(5).getDescription() == "Explore new tech");
+    }
+    std::remove(snapshotPath.c_str());
+    try
+    {
+        JournaledTaskManager orphaned(snapshotPath, journalPath, options); // the journal continues a lost snapshot
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    std::remove(journalPath.c_str());
+    return true;
+}
+
+bool testJournaledTaskManagerFailedCompaction()
+{
+    const string snapshotPath = "testJournaledTaskManagerFailedCompaction.snap";
+    const string journalPath = "testJournaledTaskManagerFailedCompaction.journal";
+    const string blockedPath = journalPath + ".tmp"; // a directory here makes starting a new journal fail
+    std::remove(snapshotPath.c_str());
+    std::remove(journalPath.c_str());
+    std::filesystem::remove_all(blockedPath);
+    JournalOptions options;
+    options.m_groupSize = 1;
+
+    TaskManager expected;
+    {
+        JournaledTaskManager journaled(snapshotPath, journalPath, options);
+        journaled.assignTask("Alice", Task(9, TaskType::Development, "Fix bug in UI"));
+        expected.assignTask("Alice", Task(9, TaskType::Development, "Fix bug in UI"));
+
+        std::filesystem::create_directory(blockedPath);
+        std::ofstream(blockedPath + "/keep"); // a directory that isn't empty survives the cleanup of a failed write
+        try
+        {
+            journaled.compact(); // the snapshot is replaced, its journal can't be started
+            return false; // should have thrown exception
+        }
+        catch (std::runtime_error &e)
+        {
+        }
+        const auto markedSize = std::filesystem::file_size(journalPath);
+        try
+        {
+            // nothing is acknowledged while it could only go to the old journal
+            journaled.assignTask("Bob", Task(7, TaskType::Meeting, "Weekly team meeting"));
+            return false; // should have thrown exception
+        }
+        catch (std::runtime_error &e)
+        {
+        }
+        try
+        {
+            journaled.commit();
+            return false; // should have thrown exception
+        }
+        catch (std::runtime_error &e)
+        {
+        }
+        expected.assignTask("Bob", Task(7, TaskType::Meeting, "Weekly team meeting"));
+        ASSERT_TEST(std::filesystem::file_size(journalPath) == markedSize); // the old journal still ends with the mark
+
+        std::filesystem::remove_all(blockedPath);
+        {
+            // so after a crash right now the files still open, with the new snapshot alone
+            JournaledTaskManager crashed(snapshotPath, journalPath, options);
+            TaskManager snapshotted;
+            snapshotted.assignTask("Alice", Task(9, TaskType::Development, "Fix bug in UI"));
+            ASSERT_TEST(printedState(crashed.manager()) == printedState(snapshotted));
+        }
+        journaled.assignTask("Bob", Task(3, TaskType::Testing, "Run system tests"));
+        expected.assignTask("Bob", Task(3, TaskType::Testing, "Run system tests"));
+        ASSERT_TEST(printedState(journaled.manager()) == printedState(expected));
+    }
+    {
+        JournaledTaskManager reopened(snapshotPath, journalPath, options);
+        ASSERT_TEST(printedState(reopened.manager()) == printedState(expected));
+
+        // like a crash between saving the snapshot and starting its journal
+        std::filesystem::create_directory(blockedPath);
+        std::ofstream(blockedPath + "/keep");
+        try
+        {
+            reopened.compact();
+            return false; // should have thrown exception
+        }
+        catch (std::runtime_error &e)
+        {
+        }
+    }
+    std::filesystem::remove_all(blockedPath);
+    {
+        // the old journal ends with the compaction mark, so it is known to be part of the new snapshot
+        JournaledTaskManager reopened(snapshotPath, journalPath, options);
+        ASSERT_TEST(printedState(reopened.manager()) == printedState(expected));
+        reopened.assignTask("Alice", Task(1, TaskType::Research, "Explore new tech"));
+    }
+
+    // a journal that doesn't continue the snapshot is refused and kept, not replaced
+    TaskManager(2).saveSnapshot(snapshotPath);
+    const auto journalSize = std::filesystem::file_size(journalPath);
+    try
+    {
+        JournaledTaskManager mismatched(snapshotPath, journalPath, options);
+        return false; // should have thrown exception
+    }
+    catch (std::runtime_error &e)
+    {
+    }
+    ASSERT_TEST(std::filesystem::file_size(journalPath) == journalSize);
+    std::remove(snapshotPath.c_str());
+    std::remove(journalPath.c_str());
+    return true;
+}
+
+bool testTaskManagerTypeIndex()
+{
+    TaskManager manager;
+    manager.assignTask("Alice", Task(99, TaskType::Testing, "Run system tests"));
+    manager.assignTask("Bob", Task(100, TaskType::Testing, "Run system tests"));
+    manager.assignTask("Alice", Task(50, TaskType::Research, "Explore new tech"));
+    manager.assignTask("Bob", Task(98, TaskType::Testing, "Integration testing"));
+
+    // both clamp to 100, so the older task goes back in front of the newer one
+    manager.bumpPriorityByType(TaskType::Testing, 5);
+    std::ostringstream bumped;
+    manager.printTasksByType(TaskType::Testing, bumped);
+    ASSERT_TEST(bumped.str() == "Task ID: 0, Priority: 100, Type: Testing, Description: Run system tests\n"
+                                "Task ID: 1, Priority: 100, Type: Testing, Description: Run system tests\n"
+                                "Task ID: 3, Priority: 100, Type: Testing, Description: Integration testing\n");
+
+    // completing Bob's first task takes it out of the index of its type, bumping another type leaves it alone
+    manager.completeTask("Bob");
+    manager.bumpPriorityByType(TaskType::Research, 1);
+    std::ostringstream completed;
+    manager.printTasksByType(TaskType::Testing, completed);
+    ASSERT_TEST(completed.str() == "Task ID: 0, Priority: 100, Type: Testing, Description: Run system tests\n"
+                                   "Task ID: 3, Priority: 100, Type: Testing, Description: Integration testing\n");
+
+    std::ostringstream research;
+    manager.printTasksByType(TaskType::Research, research);
+    ASSERT_TEST(research.str() == "Task ID: 2, Priority: 51, Type: Research, Description: Explore new tech\n");
+
+    std::ostringstream none;
+    manager.printTasksByType(TaskType::Documentation, none);
+    ASSERT_TEST(none.str().empty());
+
+    std::ostringstream all;
+    manager.printAllTasks(all);
+    ASSERT_TEST(all.str() == completed.str() + research.str());
+    return true;
+}
+
 
 // end of tests
 
@@ -472,7 +1837,30 @@ bool testTaskManagerAssignTask()
     X(testTaskManager)                       \
     X(testCopyConstructorExceptionSafety)    \
     X(testTaskManagerAssignTask)             \
-    X(testTaskManagerPrintTasksByType)
+    X(testTaskManagerPrintTasksByType)       \
+    X(testListAllocators)                    \
+    X(testListIndex)                         \
+    X(testListMoveSemantics)                 \
+    X(testListInsertRange)                   \
+    X(testListViews)                         \
+    X(testListApplyInPlace)                  \
+    X(testListMerge)                         \
+    X(testListChunkedStorage)                \
+    X(testListCompare)                       \
+    X(testTaskManagerManyPersons)            \
+    X(testTaskManagerTypeIndex)              \
+    X(testListPriorityBuckets)               \
+    X(testConcurrentTaskManager)             \
+    X(testTaskIngestionQueue)                \
+    X(testTaskExecutor)                      \
+    X(testTaskManagerAssignBatch)            \
+    X(testTaskManagerPrintToStream)          \
+    X(testTaskManagerTaskById)               \
+    X(testInternedDescriptions)              \
+    X(testTaskManagerPersonIds)              \
+    X(testTaskManagerSnapshot)               \
+    X(testJournaledTaskManager)              \
+    X(testJournaledTaskManagerFailedCompaction)
 
 
 testFunc tests[] = {